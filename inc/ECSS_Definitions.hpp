@@ -46,6 +46,12 @@ inline constexpr uint16_t ECSSSecondaryTCHeaderSize = 5U;
  */
 inline constexpr uint16_t CCSDSMaxMessageSize = ECSSMaxMessageSize + CCSDSPrimaryHeaderSize + ECSSSecondaryTMHeaderSize + 2U;
 
+/**
+ * The maximum number of concatenated TC packets that can be handled by a single call to
+ * \ref MessageParser::parseAndExecuteBatch()
+ */
+inline constexpr uint8_t ECSSMaxTCBatchSize = 64U;
+
 /**
  * The maximum size of a string to be read or appended to a Message, in bytes
  *
@@ -99,9 +105,23 @@ inline constexpr uint8_t ECSSTCRequestStringSize = 64;
 
 /**
  * The maximum number of activities that can be in the time-based schedule
+ * @details Every activity takes a fixed slot of the schedule file in MRAM, plus a few bytes of RAM for the index,
+ * so this can be raised to thousands of activities if the schedule file is large enough.
+ * @see TimeBasedSchedulingService
+ */
+inline constexpr uint16_t ECSSMaxNumberOfTimeSchedActivities = 25;
+
+/**
+ * The number of sub-schedules of the time-based schedule
+ * @see TimeBasedSchedulingService
+ */
+inline constexpr uint8_t ECSSMaxNumberOfTimeSchedSubSchedules = 8;
+
+/**
+ * The number of groups of the time-based schedule
  * @see TimeBasedSchedulingService
  */
-inline constexpr uint8_t ECSSMaxNumberOfTimeSchedActivities = 25;
+inline constexpr uint8_t ECSSMaxNumberOfTimeSchedGroups = 8;
 
 /**
  * @brief Time margin used in the time based command scheduling service ST[11]
@@ -134,6 +154,12 @@ inline constexpr uint8_t ECSSMaxDeltaOfReleaseTime = 60;
  */
 inline constexpr uint16_t ECSSMaxSimplyCommutatedParameters = 20;
 
+/**
+ * The minimum sampling interval of ST[03], in milliseconds. Housekeeping collection intervals are expressed as integer
+ * multiples of it, as per 6.3.3.2.c.5 #NOTE-2. Lowering it enables sub-second collection intervals.
+ */
+inline constexpr uint32_t ECSSHousekeepingMinimumSamplingIntervalMs = 1000;
+
 /**
  * The size of each housekeeping structure in the default array (structureId + collectionInterval(2) + isPeriodic + count + parameters)
  */
@@ -188,8 +214,20 @@ inline constexpr uint16_t ECSSMaxPacketStoreSizeInBytes = 1000;
 
 /**
  * @brief the max number of TM packets that a packet store in ST[15] can store
+ * @note Packets are stored serialized, so the number of packets that actually fit also depends on their size and on
+ * ECSSMaxPacketStoreSizeInBytes.
+ */
+inline constexpr uint16_t ECSSMaxPacketStoreSize = 64;
+
+/**
+ * @brief the size of each segment of a file-backed packet store in ST[15], in bytes
+ */
+inline constexpr uint16_t ECSSPacketStoreSegmentSize = 8192;
+
+/**
+ * @brief the max number of segments of a file-backed packet store in ST[15]
  */
-inline constexpr uint16_t ECSSMaxPacketStoreSize = 10;
+inline constexpr uint16_t ECSSMaxPacketStoreSegments = 256;
 
 /**
  * @brief the max number of packet stores that a packet selection subservice can handle in ST[15]
@@ -251,12 +289,65 @@ inline constexpr struct {
 
 /**
  * Maximum number of ST[12] Parameter Monitoring Definitions.
+ * @details Every definition takes a slot of the parameterMonitoringList, a row of the tables of the
+ * \ref ParameterMonitoringEngine and a slot of the pool of its check type, so the RAM of the service grows linearly
+ * with this and with the pools below. The default is small, so that every build does not pay for it. A mission that
+ * monitors more parameters raises it in its own definitions, up to a thousand or more, together with the pools below
+ * and \ref ECSSMonitoringMemoryBudget.
+ */
+inline constexpr uint16_t ECSSMaxMonitoringDefinitions = 32;
+
+/**
+ * Maximum number of ST[12] Parameter Monitoring Definitions of each check type.
+ * @details The pools split \ref ECSSMaxMonitoringDefinitions between the check types instead of each holding all of
+ * them, which would triple their RAM. Most monitored parameters are analog values with limits, so limit checks get
+ * 5/8 of the definitions, expected value checks of status words 1/4, and delta checks 1/8: a delta check keeps
+ * @ref ECSSMaxConsecutiveDeltaChecks + 1 samples, and takes about three times the RAM of the other check types.
+ */
+inline constexpr uint16_t ECSSMaxLimitCheckDefinitions = 20;
+inline constexpr uint16_t ECSSMaxExpectedValueCheckDefinitions = 8;
+inline constexpr uint16_t ECSSMaxDeltaCheckDefinitions = 4;
+
+static_assert(ECSSMaxLimitCheckDefinitions + ECSSMaxExpectedValueCheckDefinitions + ECSSMaxDeltaCheckDefinitions ==
+                  ECSSMaxMonitoringDefinitions,
+              "The pools of the check types must split the ST[12] definitions, without slots that can never be used");
+
+/**
+ * Maximum number of different monitoring intervals used by the ST[12] Parameter Monitoring Definitions. The
+ * definitions with the same monitoring interval are checked together.
+ */
+inline constexpr uint8_t ECSSMaxMonitoringIntervals = 16;
+
+/**
+ * Maximum number of consecutive deltas averaged by an ST[12] delta check. Each delta check keeps this many samples
+ * of its parameter, plus one.
+ */
+inline constexpr uint8_t ECSSMaxConsecutiveDeltaChecks = 8;
+
+/**
+ * Maximum number of ST[12] check transitions waiting to be reported in TM[12,12]. Must be a power of 2.
+ */
+inline constexpr uint16_t ECSSMaxCheckTransitions = 64;
+
+/**
+ * Number of check transitions waiting to be reported after which TM[12,12] is generated right away, without waiting
+ * for the maximum transition reporting delay
+ */
+inline constexpr uint16_t ECSSCheckTransitionsHighWaterMark = 48;
+
+/**
+ * Maximum RAM taken by an ST[12] \ref OnBoardMonitoringService, in bytes, checked when it is compiled.
+ * @details With the limits above, the service takes about 10 KiB, most of it for the check transitions. Each
+ * definition adds about 150 to 250 bytes, counting its slot in a pool, its rows in the tables of the
+ * \ref ParameterMonitoringEngine and its node in the parameterMonitoringList, e.g. about 180 KiB for 1024
+ * definitions. Raise it only together with the limits above.
  */
-inline constexpr uint8_t ECSSMaxMonitoringDefinitions = 8;
+inline constexpr uint32_t ECSSMonitoringMemoryBudget = 16U * 1024U;
 
 /**
  * @brief Frequency at which the checkAll method is called
- * @details This variable specifies how often the checkAll method of ST[12] should be called.
+ * @details This variable specifies how often the checkAll method of ST[12] should be called. It is the minimum
+ * sampling interval of ST[12]: each PMON definition is checked once every `monitoringInterval` calls.
  * The default value is set to 60 seconds but can be modified later.
  */
 inline constexpr std::chrono::seconds ECSSMonitoringFrequency(60);
@@ -124,7 +124,17 @@ public:
 		 * The length of the provided data exceeds the maximum number of events allowed.
 		 * This error occurs when attempting to process more events than the system can handle.
 		 */
-		LengthExceedsNumberOfEvents = 22
+		LengthExceedsNumberOfEvents = 22,
+
+		/**
+		 * The time-tag of a stored packet could not be read from the storage of its packet store in ST[15]
+		 */
+		PacketStoreReadError = 23,
+
+		/**
+		 * A change of the stored packets could not be written to the storage of their packet store in ST[15]
+		 */
+		PacketStoreWriteError = 24
 	};
 
 	/**
@@ -432,6 +442,16 @@ public:
 		 * PMON Check Type is requested, but it is missing (ST[12])
 		 */
 		PMONCheckTypeMissing = 63,
+		/**
+		 * Attempt to add a parameter monitoring definition with a monitoring interval of zero, or with a new monitoring
+		 * interval when the max number of different monitoring intervals is already in use (ST[12])
+		 */
+		InvalidMonitoringInterval = 64,
+		/**
+		 * Attempt to add or modify a delta check with zero consecutive delta checks, or with more than the max number
+		 * (ST[12])
+		 */
+		InvalidNumberOfConsecutiveDeltaChecks = 65,
 	};
 
 	/**
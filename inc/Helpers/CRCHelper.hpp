@@ -12,6 +12,12 @@ class CRCHelper {
 	 * (polynomial 0x1021, normal input), but this can change at any time
 	 * (even to a hardware CRC implementation, if available)
 	 *
+	 * Three software backends are provided, all of which produce the exact same checksum:
+	 * - Bitwise: the reference shift-register implementation of Annex B, one bit at a time
+	 * - Table: a 256-entry lookup table generated at compile time, one byte at a time
+	 * - SliceBy4 / SliceBy8: 4 or 8 lookup tables, consuming 4 or 8 bytes per iteration, which pays off
+	 *   for large buffers such as memory dumps
+	 *
 	 * Please report all found bugs.
 	 *
 	 * @author (CRC explanation) http://www.sunshine2k.de/articles/coding/crc/understanding_crc.html
@@ -39,6 +45,21 @@ private:
 	inline static const uint16_t BitNumber = 8U;
 
 public:
+	/**
+	 * The available software implementations of the CRC calculation
+	 */
+	enum class Backend : uint8_t {
+		Bitwise = 0,
+		Table = 1,
+		SliceBy4 = 2,
+		SliceBy8 = 3,
+	};
+
+	/**
+	 * The backend used by \ref CRCHelper::calculateCRC and \ref CRCHelper::Context
+	 */
+	static constexpr Backend SelectedBackend = Backend::SliceBy4;
+
 	/**
 	 * Actual CRC calculation function.
 	 * @param  message (pointer to the data to be checksummed)
@@ -47,6 +68,16 @@ public:
 	 */
 	static uint16_t calculateCRC(const uint8_t* message, uint32_t length);
 
+	/**
+	 * CRC calculation function using an explicitly chosen backend. Mostly useful for benchmarking and for
+	 * cross-checking the backends against each other.
+	 * @param  backend the implementation to use
+	 * @param  message (pointer to the data to be checksummed)
+	 * @param  length (size in bytes)
+	 * @return the CRC16 checksum of the input data
+	 */
+	static uint16_t calculateCRC(Backend backend, const uint8_t* message, uint32_t length);
+
 	/**
 	 * CRC validation function. Make sure the passed message actually contains a CRC checksum
 	 * appended at the very end!
@@ -56,10 +87,71 @@ public:
 	 */
 	static uint16_t validateCRC(const uint8_t* message, uint32_t length);
 
+	/**
+	 * Incremental CRC calculation, for data that is not contiguous in memory (e.g. a packet header and its
+	 * payload living in different buffers).
+	 *
+	 * Feeding the fragments in order through \ref update gives the same result as calling
+	 * \ref CRCHelper::calculateCRC on their concatenation.
+	 */
+	class Context {
+	public:
+		Context() = default;
+
+		/**
+		 * Resets the shift register, so that a new checksum can be calculated
+		 */
+		void init() {
+			shiftRegister = InitialShiftRegisterValue;
+		}
+
+		/**
+		 * Adds the next \p length bytes of \p data to the checksum
+		 */
+		void update(const uint8_t* data, uint32_t length);
+
+		/**
+		 * Adds a single byte to the checksum
+		 */
+		void update(uint8_t byte);
+
+		/**
+		 * @return the CRC16 checksum of all the data passed to \ref update since the last \ref init
+		 */
+		uint16_t finalize() const {
+			return shiftRegister;
+		}
+
+	private:
+		uint16_t shiftRegister = InitialShiftRegisterValue;
+	};
+
 	/**
 	 * Config bool to enable or disable CRC
 	 */
 	static constexpr bool EnableCRC = false;
+
+private:
+	/**
+	 * Continues a CRC calculation from the shift register value \p crc, one bit at a time
+	 */
+	static uint16_t updateBitwise(uint16_t crc, const uint8_t* message, uint32_t length);
+
+	/**
+	 * Continues a CRC calculation from the shift register value \p crc, one byte at a time
+	 */
+	static uint16_t updateTable(uint16_t crc, const uint8_t* message, uint32_t length);
+
+	/**
+	 * Continues a CRC calculation from the shift register value \p crc, \p Slices bytes at a time
+	 */
+	template <uint8_t Slices>
+	static uint16_t updateSliced(uint16_t crc, const uint8_t* message, uint32_t length);
+
+	/**
+	 * Continues a CRC calculation from the shift register value \p crc, using \p backend
+	 */
+	static uint16_t update(Backend backend, uint16_t crc, const uint8_t* message, uint32_t length);
 };
 
 #endif // ECSS_SERVICES_CRCHELPER_HPP
@@ -0,0 +1,131 @@
+#ifndef ECSS_SERVICES_CHECKTRANSITIONBUFFER_HPP
+#define ECSS_SERVICES_CHECKTRANSITIONBUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include "ECSS_Definitions.hpp"
+#include "PMON.hpp"
+#include "etl/array.h"
+
+/**
+ * A change of the checking status of a PMON definition, as reported in TM[12,12]
+ */
+struct CheckTransition {
+	ParameterId pmonId = 0;
+	ParameterId monitoredParameterId = 0;
+	PMON::CheckType checkType = PMON::CheckType::Limit;
+	PMON::CheckingStatus previousStatus = PMON::Unchecked;
+	PMON::CheckingStatus currentStatus = PMON::Unchecked;
+	/**
+	 * The value of the parameter for limit checks, or its delta per second for delta checks
+	 */
+	double value = 0;
+	/**
+	 * The limit or threshold that was crossed, for limit and delta checks
+	 */
+	double limitCrossed = 0;
+	/**
+	 * The bit mask of an expected value check
+	 */
+	PMONBitMask mask = 0;
+	/**
+	 * The value of the parameter, for expected value checks
+	 */
+	uint64_t unsignedValue = 0;
+	/**
+	 * The expected value of an expected value check
+	 */
+	PMONExpectedValue expectedValue = 0;
+	Time::DefaultCUC transitionTime{0};
+};
+
+/**
+ * A lock-free ring buffer of \ref CheckTransition, with a single producer and a single consumer.
+ *
+ * In \ref OnBoardMonitoringService, both the producer and the consumer run in the task that calls
+ * \ref OnBoardMonitoringService::checkAll. The buffer still allows them to be different tasks, or even an interrupt
+ * and a task, as long as there is only one of each. The producer only writes \ref tail and the consumer only writes
+ * \ref head, so no lock is needed: each side publishes its index with a release store, after it has written or read
+ * the transition it refers to.
+ *
+ * When the buffer is full, new transitions are dropped and counted, because only the consumer may remove the oldest
+ * ones.
+ */
+class CheckTransitionBuffer {
+public:
+	static constexpr uint16_t Capacity = ECSSMaxCheckTransitions;
+
+	static_assert((Capacity & (Capacity - 1U)) == 0, "The capacity must be a power of 2, so that the indices can wrap");
+	static_assert(Capacity <= (UINT16_MAX / 2U), "The indices must be able to tell a full buffer from an empty one");
+
+	/**
+	 * Appends a transition. To be called only by the producer.
+	 *
+	 * @return false if the buffer is full, in which case the transition is dropped
+	 */
+	bool push(const CheckTransition& transition) {
+		const uint16_t currentTail = tail.load(std::memory_order_relaxed);
+		if (static_cast<uint16_t>(currentTail - head.load(std::memory_order_acquire)) == Capacity) {
+			droppedTransitions.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		transitions[currentTail & IndexMask] = transition;
+		tail.store(static_cast<uint16_t>(currentTail + 1U), std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Removes the oldest transition. To be called only by the consumer.
+	 *
+	 * @return false if the buffer is empty, in which case \p transition is not modified
+	 */
+	bool pop(CheckTransition& transition) {
+		const uint16_t currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead == tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		transition = transitions[currentHead & IndexMask];
+		head.store(static_cast<uint16_t>(currentHead + 1U), std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Returns the number of transitions in the buffer. The other side may change it right after it is read: the
+	 * consumer may pop transitions, so the producer may see more transitions than there are by the time it uses the
+	 * result, and the producer may push transitions, so the consumer may see fewer.
+	 */
+	uint16_t size() const {
+		return static_cast<uint16_t>(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+	/**
+	 * Returns the number of transitions dropped because the buffer was full, since the buffer was created
+	 */
+	uint32_t getDroppedTransitions() const {
+		return droppedTransitions.load(std::memory_order_relaxed);
+	}
+
+private:
+	static constexpr uint16_t IndexMask = Capacity - 1U;
+
+	etl::array<CheckTransition, Capacity> transitions{};
+
+	/**
+	 * The index of the oldest transition, written only by the consumer. The indices run freely, and are wrapped to
+	 * positions in \ref transitions with \ref IndexMask.
+	 */
+	std::atomic<uint16_t> head{0};
+
+	/**
+	 * The index right after the newest transition, written only by the producer
+	 */
+	std::atomic<uint16_t> tail{0};
+
+	std::atomic<uint32_t> droppedTransitions{0};
+};
+
+#endif // ECSS_SERVICES_CHECKTRANSITIONBUFFER_HPP
@@ -0,0 +1,262 @@
+#ifndef ECSS_SERVICES_FILEPACKETSTOREBACKEND_HPP
+#define ECSS_SERVICES_FILEPACKETSTOREBACKEND_HPP
+
+#include "Filesystem.hpp"
+#include "PacketStoreBackend.hpp"
+
+/**
+ * A \ref PacketStoreBackend that keeps the packets in a file, accessed through \ref Filesystem::readFile and
+ * \ref Filesystem::writeFile. On the host this is a regular file, while on the satellite the platform maps the file to
+ * the MRAM or flash memory, so that a packet store can hold far more than fits in RAM.
+ *
+ * The file is split in \ref SegmentSize segments, used as a ring. Packets are only ever appended to the newest
+ * segment, and a segment is released as a whole once all of its packets have been removed. Each segment starts with
+ * a header:
+ * - a base header (magic number, sequence number, CRC), written once when the segment is opened
+ * - the number of packets removed from the front of the segment, updated while it is the oldest segment
+ * - a summary (number of packets, bytes used, time-tags of the first and last packets, CRC), written once when the
+ *   segment is full
+ *
+ * followed by the packet records (size, time-tag, CRC, packet bytes).
+ *
+ * The file is not read until the backend is first used. Then only the segment headers are read, except for the
+ * segments without a summary, i.e. the one that was being written when the satellite was reset. Their records are
+ * checked one by one, and the segment is truncated after the last record with a valid CRC. Every CRC includes the
+ * sequence number of its segment, so that stale records of a previous use of a segment are never mistaken for valid
+ * ones.
+ *
+ * The time-tags of the first and last packets of every segment are kept in RAM, so that a search by time-tag first
+ * finds the segment without reading the file. Only the location and time-tag of the records of one segment at a time
+ * are cached in RAM, so reading a packet from another segment first reads the record headers of that segment. They are
+ * read in chunks of up to \ref recordBuffer bytes, each holding as many records as fit.
+ */
+class FilePacketStoreBackend final : public PacketStoreBackend {
+public:
+	static constexpr uint16_t SegmentSize = ECSSPacketStoreSegmentSize;
+
+	static constexpr uint16_t HeaderSize = 32;
+
+	/**
+	 * The size of the size, time-tag and CRC fields of a record
+	 */
+	static constexpr uint16_t RecordHeaderSize = 8;
+
+	static constexpr uint16_t MaxRecordsPerSegment = (SegmentSize - HeaderSize) / RecordHeaderSize;
+
+	/**
+	 * The number of times a write to the file is attempted before it is reported as failed
+	 */
+	static constexpr uint8_t MaxWriteAttempts = 3;
+
+	static_assert(SegmentSize >= HeaderSize + RecordHeaderSize + CCSDSMaxMessageSize,
+	              "A segment must fit at least one packet of the maximum size");
+
+	/**
+	 * @param path The file that holds the packets
+	 * @param numberOfSegments The size of the file, in segments. Between 1 and \ref ECSSMaxPacketStoreSegments.
+	 */
+	FilePacketStoreBackend(const Filesystem::Path& path, uint16_t numberOfSegments);
+
+	AppendResult append(Time::DefaultCUC timeTag, etl::span<const uint8_t> packet) override;
+
+	bool removeOldest() override;
+
+	bool clear() override;
+
+	size_t packetCount() const override;
+
+	etl::optional<Time::DefaultCUC> timeTag(size_t position) const override;
+
+	etl::optional<size_t> lowerBound(Time::DefaultCUC timeTag) const override;
+
+	etl::optional<size_t> upperBound(Time::DefaultCUC timeTag) const override;
+
+	etl::span<const uint8_t> packet(size_t position) const override;
+
+	uint32_t cumulativeSize(size_t position) const override;
+
+	uint32_t sizeInBytes() const override;
+
+	uint32_t capacityInBytes() const override {
+		return static_cast<uint32_t>(numberOfSegments) * (SegmentSize - HeaderSize);
+	}
+
+	uint32_t maxPacketSize() const override {
+		return CCSDSMaxMessageSize;
+	}
+
+private:
+	/**
+	 * The state of a segment that is in use
+	 */
+	struct Segment {
+		uint32_t sequence = 0;
+		/**
+		 * The number of records in the segment, including the removed ones
+		 */
+		uint16_t recordCount = 0;
+		/**
+		 * The number of records removed from the front of the segment
+		 */
+		uint16_t removedRecords = 0;
+		/**
+		 * The position right after the last record of the segment
+		 */
+		uint16_t usedBytes = HeaderSize;
+		/**
+		 * The value of \ref appendedBytes right before the first record of the segment was appended
+		 */
+		uint32_t cumulativeStart = 0;
+		/**
+		 * The time-tags of the first and last records of the segment, including the removed ones
+		 */
+		Time::DefaultCUC firstTimeTag{0};
+		Time::DefaultCUC lastTimeTag{0};
+	};
+
+	/**
+	 * The position of a packet in the file
+	 */
+	struct RecordLocation {
+		uint16_t segment = 0;
+		uint16_t record = 0;
+	};
+
+	static constexpr uint16_t NoSegment = UINT16_MAX;
+
+	Filesystem::Path path;
+
+	uint16_t numberOfSegments;
+
+	// The state below is loaded from the file on first use, so it is also modified by the const functions
+
+	mutable bool isLoaded = false;
+
+	mutable etl::array<Segment, ECSSMaxPacketStoreSegments> segments{};
+
+	/**
+	 * The oldest segment in use
+	 */
+	mutable uint16_t headSegment = 0;
+
+	mutable uint16_t usedSegments = 0;
+
+	/**
+	 * Whether the newest segment has been summarized, so that no more records can be appended to it
+	 */
+	mutable bool isTailSealed = false;
+
+	mutable uint32_t nextSequence = 1;
+
+	mutable uint32_t storedPackets = 0;
+
+	mutable uint32_t storedBytes = 0;
+
+	/**
+	 * The number of bytes appended since the backend was created, or since the file was loaded
+	 */
+	mutable uint32_t appendedBytes = 0;
+
+	/**
+	 * The segment whose record positions are in \ref recordOffsets
+	 */
+	mutable uint16_t cachedSegment = NoSegment;
+
+	mutable uint32_t cachedSequence = 0;
+
+	/**
+	 * The position of each record of \ref cachedSegment, followed by the position right after the last record
+	 */
+	mutable etl::array<uint16_t, MaxRecordsPerSegment + 1> recordOffsets{};
+
+	/**
+	 * The time-tag of each record of \ref cachedSegment, as stored in the record
+	 */
+	mutable etl::array<uint32_t, MaxRecordsPerSegment> recordTimeTags{};
+
+	/**
+	 * Holds a record while it is written, or a packet after it is read
+	 */
+	mutable etl::array<uint8_t, RecordHeaderSize + CCSDSMaxMessageSize> recordBuffer{};
+
+	uint16_t tailSegment() const {
+		return (headSegment + usedSegments - 1) % numberOfSegments;
+	}
+
+	uint32_t segmentOffset(uint16_t segment) const {
+		return static_cast<uint32_t>(segment) * SegmentSize;
+	}
+
+	/**
+	 * Reads the segment headers from the file, and recovers the segment that was being written, if needed
+	 *
+	 * @details The segments in use are the longest run of consecutive sequence numbers that ends at the newest
+	 * segment. A segment outside of it, e.g. one whose release could not be written, is ignored even if its base
+	 * header is valid.
+	 */
+	void load() const;
+
+	/**
+	 * Writes \p data at \p offset of the file, trying again up to \ref MaxWriteAttempts times if it fails
+	 *
+	 * @return false if all the attempts failed
+	 */
+	bool writeWithRetries(uint32_t offset, etl::span<const uint8_t> data) const;
+
+	/**
+	 * Finds the positions and time-tags of the records of \p segment and stores them in \ref recordOffsets and
+	 * \ref recordTimeTags
+	 *
+	 * @param isRecovering Whether the number of records is unknown. In this case every record is read on its own and
+	 * checked against its CRC, and the records are counted up to the first invalid one.
+	 * @return The number of records found, which is less than the number of records of the segment if they could not
+	 * all be read. The records are then not cached, so they are read again on the next call.
+	 */
+	uint16_t cacheRecordOffsets(uint16_t segment, bool isRecovering) const;
+
+	/**
+	 * Finds the oldest packet whose time-tag is later than \p timeTag, or also equal to it if \p isEqualLater is set.
+	 * Only the record headers of the segment that holds it are read.
+	 */
+	etl::optional<size_t> findFirstLaterPacket(Time::DefaultCUC timeTag, bool isEqualLater) const;
+
+	RecordLocation locate(size_t position) const;
+
+	/**
+	 * Returns the size of the packet of the record at \p location, using \ref recordOffsets, or nothing if the
+	 * record headers of its segment could not be read up to it
+	 */
+	etl::optional<uint16_t> recordPacketSize(RecordLocation location) const {
+		if (cacheRecordOffsets(location.segment, false) <= location.record) {
+			return {};
+		}
+		return recordOffsets[location.record + 1] - recordOffsets[location.record] - RecordHeaderSize;
+	}
+
+	/**
+	 * Writes the base header of a new segment after the newest one, with no records
+	 */
+	bool openSegment();
+
+	/**
+	 * Writes the summary of the newest segment
+	 */
+	bool sealTailSegment();
+
+	/**
+	 * Writes the number of removed records of the oldest segment
+	 *
+	 * @return false if it could not be written
+	 */
+	bool writeRemovedRecords() const;
+
+	/**
+	 * Invalidates the base header of the oldest segment, so that it is not loaded again. The segment is released in
+	 * RAM even if the header could not be written.
+	 *
+	 * @return false if the header could not be written
+	 */
+	bool releaseHeadSegment() const;
+};
+
+#endif // ECSS_SERVICES_FILEPACKETSTOREBACKEND_HPP
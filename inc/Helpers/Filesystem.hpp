@@ -4,6 +4,7 @@
 #include "etl/String.hpp"
 #include "etl/optional.h"
 #include "etl/result.h"
+#include "etl/span.h"
 
 namespace Filesystem {
 	constexpr size_t FullPathSize = ECSSMaxStringSize;
@@ -83,6 +84,15 @@ namespace Filesystem {
 		FileDoesNotExist = 1
 	};
 
+	/**
+	 * Possible errors returned by the filesystem when reading or writing the contents of a file
+	 */
+	enum class FileAccessError : uint8_t {
+		FileDoesNotExist = 0,
+		OutOfBounds = 1,
+		UnknownError = 255
+	};
+
 	/**
 	 * Creates a file using platform specific filesystem functions
 	 * @param path A String representing the path on the filesystem
@@ -154,6 +164,24 @@ namespace Filesystem {
 	 */
 	FileLockStatus getFileLockStatus(const Path& path);
 
+	/**
+	 * Reads the contents of a file using platform specific filesystem functions
+	 * @param path A String representing the path on the filesystem
+	 * @param offset The position of the first byte to read, from the start of the file
+	 * @param data The buffer to fill. Exactly data.size() bytes are read.
+	 * @return Optionally, a file access error. If no errors occur, returns etl::nullopt
+	 */
+	etl::optional<FileAccessError> readFile(const Path& path, uint32_t offset, etl::span<uint8_t> data);
+
+	/**
+	 * Writes to a file using platform specific filesystem functions. The file is created, or extended, if needed.
+	 * @param path A String representing the path on the filesystem
+	 * @param offset The position of the first byte to write, from the start of the file
+	 * @param data The bytes to write
+	 * @return Optionally, a file access error. If no errors occur, returns etl::nullopt
+	 */
+	etl::optional<FileAccessError> writeFile(const Path& path, uint32_t offset, etl::span<const uint8_t> data);
+
 	/**
 	 * Get the Unallocated Memory
 	 * @return The unallocated memory in bytes 
@@ -0,0 +1,178 @@
+#ifndef ECSS_SERVICES_INDEXEDMINHEAP_HPP
+#define ECSS_SERVICES_INDEXEDMINHEAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <etl/array.h>
+
+/**
+ * A binary min-heap of a fixed set of IDs, each with a key, that supports changing or removing the key of any ID.
+ *
+ * IDs are small integers in `[0, Capacity)` (e.g. the slot of a structure in a table), so the position of each ID in
+ * the heap is kept in a plain array. This gives:
+ * - O(1) access to the ID with the smallest key
+ * - O(log n) insertion, key update and removal of any ID
+ *
+ * IDs with equal keys are ordered by ID, so that the order of the heap is deterministic.
+ *
+ * @tparam Key The type of the keys, e.g. a due time
+ * @tparam Capacity The number of possible IDs
+ */
+template <typename Key, size_t Capacity>
+class IndexedMinHeap {
+public:
+	using IdType = uint16_t;
+
+	static_assert(Capacity < UINT16_MAX, "The IDs of the heap must fit in a uint16_t");
+
+	/**
+	 * Position of an ID that is not in the heap
+	 */
+	static constexpr IdType NotInHeap = UINT16_MAX;
+
+	IndexedMinHeap() {
+		clear();
+	}
+
+	/**
+	 * Removes all IDs from the heap
+	 */
+	void clear() {
+		positions.fill(NotInHeap);
+		count = 0;
+	}
+
+	bool empty() const {
+		return count == 0;
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+	bool contains(IdType id) const {
+		return (id < Capacity) && (positions[id] != NotInHeap);
+	}
+
+	/**
+	 * @return The ID with the smallest key. The heap must not be empty.
+	 */
+	IdType top() const {
+		return heap[0];
+	}
+
+	/**
+	 * @return The smallest key in the heap. The heap must not be empty.
+	 */
+	Key topKey() const {
+		return keys[heap[0]];
+	}
+
+	/**
+	 * @return The key of \p id. \p id must be in the heap.
+	 */
+	Key key(IdType id) const {
+		return keys[id];
+	}
+
+	/**
+	 * Inserts \p id in the heap, or changes its key if it is already there
+	 */
+	void insertOrUpdate(IdType id, Key key) {
+		if (id >= Capacity) {
+			return;
+		}
+		keys[id] = key;
+
+		if (positions[id] == NotInHeap) {
+			heap[count] = id;
+			positions[id] = count;
+			count++;
+			siftUp(count - 1);
+			return;
+		}
+
+		siftUp(positions[id]);
+		siftDown(positions[id]);
+	}
+
+	/**
+	 * Removes \p id from the heap, if it is there
+	 */
+	void remove(IdType id) {
+		if (not contains(id)) {
+			return;
+		}
+
+		const IdType position = positions[id];
+		count--;
+		if (position != count) {
+			place(position, heap[count]);
+			siftUp(position);
+			siftDown(positions[heap[position]]);
+		}
+		positions[id] = NotInHeap;
+	}
+
+private:
+	/**
+	 * The IDs, ordered as a binary heap
+	 */
+	etl::array<IdType, Capacity> heap{};
+
+	/**
+	 * The position of each ID in \ref heap, or \ref NotInHeap
+	 */
+	etl::array<IdType, Capacity> positions{};
+
+	/**
+	 * The key of each ID
+	 */
+	etl::array<Key, Capacity> keys{};
+
+	IdType count = 0;
+
+	bool isBefore(IdType first, IdType second) const {
+		return (keys[first] < keys[second]) || (not(keys[second] < keys[first]) && (first < second));
+	}
+
+	void place(IdType position, IdType id) {
+		heap[position] = id;
+		positions[id] = position;
+	}
+
+	void siftUp(IdType position) {
+		const IdType id = heap[position];
+		while (position > 0) {
+			const IdType parent = (position - 1) / 2;
+			if (not isBefore(id, heap[parent])) {
+				break;
+			}
+			place(position, heap[parent]);
+			position = parent;
+		}
+		place(position, id);
+	}
+
+	void siftDown(IdType position) {
+		const IdType id = heap[position];
+		while (true) {
+			const size_t left = 2U * position + 1U;
+			if (left >= count) {
+				break;
+			}
+			size_t smallest = left;
+			if ((left + 1U < count) && isBefore(heap[left + 1U], heap[left])) {
+				smallest = left + 1U;
+			}
+			if (not isBefore(heap[smallest], id)) {
+				break;
+			}
+			place(position, heap[smallest]);
+			position = static_cast<IdType>(smallest);
+		}
+		place(position, id);
+	}
+};
+
+#endif // ECSS_SERVICES_INDEXEDMINHEAP_HPP
@@ -6,6 +6,7 @@
 #include "Message.hpp"
 #include "Service.hpp"
 #include "TimeGetter.hpp"
+#include "etl/algorithm.h"
 #include "etl/array.h"
 #include "etl/functional.h"
 #include "etl/map.h"
@@ -40,6 +41,11 @@ public:
 	 */
 	PMONRepetitionNumber repetitionNumber;
 
+	/**
+	 * The number of minimum sampling intervals (@ref ECSSMonitoringFrequency) between two checks of this definition.
+	 */
+	PMONMonitoringInterval monitoringInterval = 1;
+
 	/**
 	 * The number of consecutive checks with the same result that have been conducted so far.
 	 */
@@ -53,9 +59,10 @@ public:
 	CheckingStatus checkingStatus = Unchecked;
 
 	/**
-	 * The list of Checking Statuses that have been recorded so far.
+	 * The previous and the current Checking Status of the last check transition. A check transition is recorded when
+	 * @ref repetitionNumber consecutive checks have given a status other than the current one.
 	 */
-	etl::array<CheckingStatus, 2> checkTransitionList = {};
+	etl::array<CheckingStatus, 2> checkTransitionList = {Unchecked, Unchecked};
 
 	/**
 	 * The check type of this monitoring definition, set by the child classes to differentiate between class types
@@ -180,9 +187,9 @@ public:
 		uint64_t maskedValue = currentValueAsUint64 & getMask();
 
 		if (maskedValue == getExpectedValue()) {
-			checkingStatus = UnexpectedValue;
-		} else {
 			checkingStatus = ExpectedValue;
+		} else {
+			checkingStatus = UnexpectedValue;
 		}
 
 		if (checkingStatus == previousStatus) {
@@ -276,9 +283,35 @@ public:
 	DeltaThreshold highDeltaThreshold;
 	EventDefinitionId aboveHighThresholdEvent;
 
+	/**
+	 * The time of a sample of the monitored parameter, in \ref Time::DefaultCUC ticks
+	 */
+	using SampleTime = uint32_t;
+
+	/**
+	 * The duration of a \ref SampleTime tick, in seconds
+	 */
+	static constexpr double SecondsPerTick =
+	    static_cast<double>(Time::DefaultCUC::Ratio::num) / static_cast<double>(Time::DefaultCUC::Ratio::den);
+
 private:
-	double previousValue;
-	etl::optional<UTCTimestamp> previousTimestamp;
+	/**
+	 * The number of samples kept, enough for the longest window of consecutive delta checks
+	 */
+	static constexpr uint8_t SampleCapacity = ECSSMaxConsecutiveDeltaChecks + 1;
+
+	/**
+	 * The last samples of the monitored parameter, used as a ring buffer
+	 */
+	etl::array<double, SampleCapacity> sampleValues{};
+	etl::array<SampleTime, SampleCapacity> sampleTimes{};
+
+	/**
+	 * The position of the newest sample in \ref sampleValues
+	 */
+	uint8_t newestSample = 0;
+
+	uint8_t sampleCount = 0;
 
 public:
 	explicit PMONDeltaCheck(ParameterId monitoredParameterId, PMONRepetitionNumber repetitionNumber,
@@ -287,7 +320,7 @@ public:
 	                        EventDefinitionId aboveHighThresholdEvent)
 	    : PMON(monitoredParameterId, repetitionNumber, CheckType::Delta), numberOfConsecutiveDeltaChecks(numberOfConsecutiveDeltaChecks), lowDeltaThreshold(lowDeltaThreshold),
 	      belowLowThresholdEvent(belowLowThresholdEvent), highDeltaThreshold(highDeltaThreshold),
-	      aboveHighThresholdEvent(aboveHighThresholdEvent), previousValue(0.0) {
+	      aboveHighThresholdEvent(aboveHighThresholdEvent) {
 	}
 
 	/**
@@ -326,46 +359,65 @@ public:
 	}
 
 	/**
-	 * This method updates the last value and timestamp of the PMONDeltaCheck object.
+	 * Returns the number of consecutive deltas averaged by the check, between 1 and @ref ECSSMaxConsecutiveDeltaChecks
 	 */
-	void updatePreviousValueAndTimestamp(double newValue, const UTCTimestamp& newTimestamp) {
-		previousValue = newValue;
-		previousTimestamp = newTimestamp;
+	uint8_t getWindowLength() const {
+		return static_cast<uint8_t>(
+		    etl::clamp<NumberOfConsecutiveDeltaChecks>(numberOfConsecutiveDeltaChecks, 1, ECSSMaxConsecutiveDeltaChecks));
 	}
 
 	/**
-	 * Returns the delta per second between the current value and the previous one.
+	 * Stores a new sample of the monitored parameter, and computes the average delta per second of the last
+	 * @ref numberOfConsecutiveDeltaChecks consecutive deltas.
+	 *
+	 * The average of consecutive deltas only depends on the first and the last sample, so it is computed from the new
+	 * sample and the one @ref numberOfConsecutiveDeltaChecks samples before it, whatever the length of the window.
+	 *
+	 * @param time The time of the sample. Only differences between sample times are used, so it may overflow.
+	 * @return The average delta per second, or nothing if there are not enough samples yet
 	 */
-	double getDeltaPerSecond(double currentValue) const {
-		if (previousTimestamp.has_value()) {
-			double delta = currentValue - previousValue;
-			auto duration = TimeGetter::getCurrentTimeUTC() - *previousTimestamp;
-			double deltaSeconds = std::chrono::duration<double>(duration).count();
+	etl::optional<double> addSample(double value, SampleTime time) {
+		newestSample = static_cast<uint8_t>((newestSample + 1U) % SampleCapacity);
+		sampleValues[newestSample] = value;
+		sampleTimes[newestSample] = time;
+		if (sampleCount < SampleCapacity) {
+			sampleCount++;
+		}
 
-			if (deltaSeconds == 0) {
-				return 0;
-			}
-			return delta / deltaSeconds;
+		const uint8_t windowLength = getWindowLength();
+		if (sampleCount <= windowLength) {
+			return {};
+		}
+		const uint8_t oldestSample = static_cast<uint8_t>((newestSample + SampleCapacity - windowLength) % SampleCapacity);
+		const SampleTime elapsedTicks = time - sampleTimes[oldestSample];
+		if (elapsedTicks == 0) {
+			return 0.0;
 		}
-		return 0;
+		return (value - sampleValues[oldestSample]) / (elapsedTicks * SecondsPerTick);
+	}
+
+	/**
+	 * Forgets all the samples, so that the next @ref numberOfConsecutiveDeltaChecks checks are Invalid
+	 */
+	void clearSamples() {
+		sampleCount = 0;
 	}
 
 	/**
-	 * This method checks if the PMON has a previous value by verifying if the previous timestamp has value.
+	 * This method checks if the PMON has a previous sample of its parameter.
 	 */
 	bool hasOldValue() const {
-		return previousTimestamp.has_value();
+		return sampleCount > 0;
 	}
 
 	/**
 	 * @brief Performs the check for the PMONDeltaCheck class.
 	 *
-	 * This function first retrieves the current value of the monitored parameter and the current timestamp.
-	 * If there is a previous value, it calculates the delta per second between the current and previous values.
+	 * This function first retrieves the current value of the monitored parameter and the current time, and adds them
+	 * to the samples of the check. If there are enough samples, it calculates the average delta per second of the last
+	 * @ref numberOfConsecutiveDeltaChecks consecutive deltas (see @ref addSample).
 	 * Depending on the delta per second, it sets the checking status to BelowLowThreshold, AboveHighThreshold, or WithinThreshold.
-	 * If there is no previous value, it sets the checking status to Invalid.
-	 *
-	 * After the check, the function updates the previous value and timestamp to the current ones.
+	 * If there are not enough samples yet, it sets the checking status to Invalid.
 	 *
 	 * @note This function overrides the pure virtual function in the base PMON class.
 	 * @note The delta check is performed on the actual difference between the previous and the current
@@ -374,13 +426,12 @@ public:
 	void performCheck() override {
 		auto previousStatus = checkingStatus;
 		auto currentValue = MemoryManager::getParameterAsDOUBLE(monitoredParameterId).value();
-		auto currentTimestamp = TimeGetter::getCurrentTimeUTC();
+		auto currentTime = TimeGetter::getCurrentTimeDefaultCUC().formatAsBytes();
 
-		if (hasOldValue()) {
-			double deltaPerSecond = getDeltaPerSecond(currentValue);
-			if (deltaPerSecond < getLowDeltaThreshold()) {
+		if (auto deltaPerSecond = addSample(currentValue, currentTime)) {
+			if (*deltaPerSecond < getLowDeltaThreshold()) {
 				checkingStatus = BelowLowThreshold;
-			} else if (deltaPerSecond > getHighDeltaThreshold()) {
+			} else if (*deltaPerSecond > getHighDeltaThreshold()) {
 				checkingStatus = AboveHighThreshold;
 			} else {
 				checkingStatus = WithinThreshold;
@@ -389,8 +440,6 @@ public:
 			checkingStatus = Invalid;
 		}
 
-		updatePreviousValueAndTimestamp(currentValue, currentTimestamp);
-
 		if (checkingStatus == previousStatus) {
 			repetitionCounter++;
 		} else {
@@ -4,8 +4,8 @@
 #include "ECSS_Definitions.hpp"
 #include "ErrorHandler.hpp"
 #include "Message.hpp"
-#include "etl/deque.h"
-#include "numeric"
+#include "PacketStoreBackend.hpp"
+#include "etl/span.h"
 
 /**
  * This is the Packet Store class, needed for the Storage-Retrieval Service. The purpose of the packet-store is to
@@ -52,7 +52,7 @@ public:
 		                                         InProgress = true };
 
 	/**
-+	 * Whether the storage of TM packets is enabled for this packet store
+	 * Whether the storage of TM packets is enabled for this packet store
 	 */
 	bool storageStatus = false;
 
@@ -66,20 +66,192 @@ public:
 	PacketStore() = default;
 
 	/**
-	 * A queue containing the TM messages stored by the packet store. Every TM is accompanied by its timestamp.
+	 * Stores a serialized TM packet, accompanied by its time-tag.
 	 *
-	 * @note A convention is made that this should be filled out using `push_back` and NOT `push_front`, dictating that
-	 * earlier packets are placed in the front position. So removing the earlier packets is done with `pop_front`.
+	 * When there is not enough room for the packet, a Circular packet store drops its oldest packets until the new
+	 * one fits, while a Bounded packet store rejects the new packet.
 	 *
-	 * 				old packets  <---------->  new packets
-	 * 				[][][][][][][][][][][][][][][][][][][]	<--- deque
+	 * @note The packet is stored in the backend set with \ref setBackend, or in RAM if there is none.
+	 *
+	 * @return false if the packet was not stored, either because there is no room for it, because its time-tag is
+	 * earlier than the one of the newest stored packet, or because it could not be written
+	 */
+	bool storePacket(Time::DefaultCUC timeTag, etl::span<const uint8_t> packet);
+
+	/**
+	 * Removes the oldest stored packet, if there is one
+	 */
+	void removeOldestPacket();
+
+	/**
+	 * Removes all the stored packets whose time-tag is earlier than or equal to \p timeLimit
+	 */
+	void removePacketsUntil(Time::DefaultCUC timeLimit);
+
+	/**
+	 * Removes all the stored packets
+	 */
+	void clearPackets();
+
+	/**
+	 * Stores the packets of this packet store in \p newBackend, instead of RAM. Passing nullptr switches back to RAM.
+	 * The packets stored in the previous backend are not moved, and the retrieval processes start over from the
+	 * oldest packet of the new backend.
+	 *
+	 * @param newBackend must outlive the packet store and every copy of it
+	 */
+	void setBackend(PacketStoreBackend* newBackend) {
+		backend = newBackend;
+		openRetrievalCursor = 0;
+		byTimeRangeRetrievalCursor = 0;
+		byTimeRangeRetrievalEnd = upperBound(retrievalEndTime);
+	}
+
+	bool empty() const {
+		return storage().packetCount() == 0;
+	}
+
+	/**
+	 * Returns the number of stored packets
 	 */
-	etl::deque<std::pair<Time::DefaultCUC, Message>, ECSSMaxPacketStoreSize> storedTelemetryPackets;
+	size_t packetCount() const {
+		return storage().packetCount();
+	}
+
+	/**
+	 * Returns the time-tag of the \p position-th oldest stored packet
+	 *
+	 * @note If the time-tag cannot be read, an internal error is reported, and the time-tag of the nearest readable
+	 * packet is returned instead, preferably an older one. The time-tags then stay sorted, so that the searches by
+	 * time-tag still find the readable packets.
+	 */
+	Time::DefaultCUC timeTag(size_t position) const;
+
+	/**
+	 * Returns the bytes of the \p position-th oldest stored packet. The span points inside the packet store, and is
+	 * only valid until the next packet is read, stored or removed.
+	 */
+	etl::span<const uint8_t> packet(size_t position) const {
+		return storage().packet(position);
+	}
 
 	/**
 	 * Returns the sum of the sizes of the packets stored in this PacketStore, in bytes.
 	 */
-	uint16_t calculateSizeInBytes();
+	uint32_t calculateSizeInBytes() const {
+		return storage().sizeInBytes();
+	}
+
+	/**
+	 * Returns the number of bytes that the packet store can hold
+	 */
+	uint32_t capacityInBytes() const {
+		return storage().capacityInBytes();
+	}
+
+	/**
+	 * Returns the position of the oldest stored packet whose time-tag is later than or equal to \p timeTag, or
+	 * \ref packetCount if there is none
+	 */
+	size_t lowerBound(Time::DefaultCUC timeTag) const;
+
+	/**
+	 * Returns the position of the oldest stored packet whose time-tag is later than \p timeTag, or \ref packetCount
+	 * if there is none
+	 */
+	size_t upperBound(Time::DefaultCUC timeTag) const;
+
+	/**
+	 * Returns the total size of the packets in positions [\p first, \p last), in bytes
+	 */
+	uint32_t calculateSizeInBytes(size_t first, size_t last) const {
+		if (first >= last) {
+			return 0;
+		}
+		return storage().cumulativeSize(last) - storage().cumulativeSize(first);
+	}
+
+	/**
+	 * Stores a copy of the packets in positions [\p first, \p last) into \p destination
+	 */
+	void copyPackets(size_t first, size_t last, PacketStore& destination) const;
+
+	/**
+	 * Moves the open retrieval process to the oldest packet whose time-tag is not earlier than
+	 * \ref openRetrievalStartTimeTag
+	 */
+	void rewindOpenRetrieval() {
+		openRetrievalCursor = lowerBound(openRetrievalStartTimeTag);
+	}
+
+	/**
+	 * Moves the by-time-range retrieval process to the oldest packet whose time-tag is not earlier than
+	 * \ref retrievalStartTime, and finds the packet where it ends from \ref retrievalEndTime
+	 */
+	void rewindByTimeRangeRetrieval() {
+		byTimeRangeRetrievalCursor = lowerBound(retrievalStartTime);
+		byTimeRangeRetrievalEnd = upperBound(retrievalEndTime);
+	}
+
+	/**
+	 * Finds the next packet to be downlinked by the retrieval process in progress. The by-time-range retrieval is
+	 * served first, and is disabled once every packet up to \ref retrievalEndTime has been retrieved. The open
+	 * retrieval never completes, as it also retrieves the packets stored after it started.
+	 *
+	 * The packet stays the next one to retrieve until \ref markPacketRetrieved is called, so that it is not lost if it
+	 * cannot be downlinked right away.
+	 *
+	 * @param packet set to the bytes of the next packet, which point inside the packet store
+	 * @return false if there is no packet to retrieve
+	 */
+	bool nextPacketToRetrieve(etl::span<const uint8_t>& packet);
+
+	/**
+	 * Moves the retrieval process in progress past the packet returned by \ref nextPacketToRetrieve
+	 */
+	void markPacketRetrieved();
+
+private:
+	/**
+	 * The storage of the packets, or nullptr to keep them in \ref ramBackend
+	 */
+	PacketStoreBackend* backend = nullptr;
+
+	/**
+	 * The storage of the packets when no \ref backend is set
+	 */
+	RamPacketStoreBackend ramBackend;
+
+	/**
+	 * The position of the next packet to be downlinked by the open retrieval process
+	 */
+	size_t openRetrievalCursor = 0;
+
+	/**
+	 * The position of the next packet to be downlinked by the by-time-range retrieval process
+	 */
+	size_t byTimeRangeRetrievalCursor = 0;
+
+	/**
+	 * The position right after the last packet to be downlinked by the by-time-range retrieval process, i.e. the
+	 * \ref upperBound of \ref retrievalEndTime. It is kept up to date as packets are stored and removed, so that the
+	 * time-tags are not searched again for every retrieved packet.
+	 */
+	size_t byTimeRangeRetrievalEnd = 0;
+
+	PacketStoreBackend& storage() {
+		if (backend != nullptr) {
+			return *backend;
+		}
+		return ramBackend;
+	}
+
+	const PacketStoreBackend& storage() const {
+		if (backend != nullptr) {
+			return *backend;
+		}
+		return ramBackend;
+	}
 };
 
 #endif
@@ -0,0 +1,231 @@
+#ifndef ECSS_SERVICES_PACKETSTOREBACKEND_HPP
+#define ECSS_SERVICES_PACKETSTOREBACKEND_HPP
+
+#include "ECSS_Definitions.hpp"
+#include "TimeStamp.hpp"
+#include "etl/array.h"
+#include "etl/deque.h"
+#include "etl/optional.h"
+#include "etl/span.h"
+
+/**
+ * The storage of the serialized TM packets of a \ref PacketStore, together with their time-tags.
+ *
+ * Packets are appended at the end and removed from the front, so every stored packet is addressed by its position,
+ * starting from 0 for the oldest one. A backend only stores packets; the policies of the packet store (e.g. whether
+ * old packets are overwritten when the backend is full) are applied by \ref PacketStore.
+ */
+class PacketStoreBackend {
+public:
+	/**
+	 * The outcome of \ref append
+	 */
+	enum class AppendResult : uint8_t {
+		Stored,
+		/**
+		 * There is no room for the packet, so nothing is stored
+		 */
+		NoRoom,
+		/**
+		 * The packet could not be written, so nothing is stored. Removing packets does not help.
+		 */
+		WriteError,
+	};
+
+	virtual ~PacketStoreBackend() = default;
+
+	/**
+	 * Stores a packet after the newest one
+	 */
+	virtual AppendResult append(Time::DefaultCUC timeTag, etl::span<const uint8_t> packet) = 0;
+
+	/**
+	 * Removes the oldest packet, if there is one
+	 *
+	 * @return false if the removal could not be written, in which case the packet is removed, but may be found again
+	 * after a reset
+	 */
+	virtual bool removeOldest() = 0;
+
+	/**
+	 * Removes all the packets
+	 *
+	 * @return false if the removal could not be written, in which case the packets are removed, but some of them may be
+	 * found again after a reset
+	 */
+	virtual bool clear() = 0;
+
+	virtual size_t packetCount() const = 0;
+
+	/**
+	 * Returns the time-tag of the packet at \p position, or nothing if it cannot be read
+	 */
+	virtual etl::optional<Time::DefaultCUC> timeTag(size_t position) const = 0;
+
+	/**
+	 * Returns the position of the oldest packet whose time-tag is later than or equal to \p timeTag, or
+	 * \ref packetCount if there is none. Returns nothing if the backend cannot find it faster than a binary search over
+	 * \ref timeTag, e.g. because a time-tag cannot be read.
+	 */
+	virtual etl::optional<size_t> lowerBound(Time::DefaultCUC timeTag) const {
+		return {};
+	}
+
+	/**
+	 * Returns the position of the oldest packet whose time-tag is later than \p timeTag, or \ref packetCount if there
+	 * is none. Returns nothing if the backend cannot find it faster than a binary search over \ref timeTag.
+	 */
+	virtual etl::optional<size_t> upperBound(Time::DefaultCUC timeTag) const {
+		return {};
+	}
+
+	/**
+	 * Returns the bytes of the packet at \p position. The span is only valid until the next call to any function of
+	 * the backend.
+	 */
+	virtual etl::span<const uint8_t> packet(size_t position) const = 0;
+
+	/**
+	 * Returns the number of bytes appended before the packet at \p position, since the backend was created. If
+	 * \p position is \ref packetCount, returns the number of bytes appended so far. Only differences between two
+	 * positions are meaningful, so the counter may overflow.
+	 */
+	virtual uint32_t cumulativeSize(size_t position) const = 0;
+
+	/**
+	 * Returns the sum of the sizes of the stored packets, in bytes
+	 */
+	virtual uint32_t sizeInBytes() const = 0;
+
+	/**
+	 * Returns the number of bytes that can be stored when the backend is empty
+	 */
+	virtual uint32_t capacityInBytes() const = 0;
+
+	/**
+	 * Returns the size of the largest packet that can ever be stored, in bytes
+	 */
+	virtual uint32_t maxPacketSize() const = 0;
+};
+
+/**
+ * The default \ref PacketStoreBackend, which keeps the packets in RAM.
+ *
+ * The serialized packets are stored back to back in a fixed byte buffer, used as a ring buffer, next to a small index
+ * with the time-tag and location of each packet.
+ */
+class RamPacketStoreBackend final : public PacketStoreBackend {
+public:
+	/**
+	 * The number of bytes available for the serialized packets
+	 */
+	static constexpr uint16_t DataCapacity = ECSSMaxPacketStoreSizeInBytes;
+
+	AppendResult append(Time::DefaultCUC timeTag, etl::span<const uint8_t> packet) override;
+
+	bool removeOldest() override;
+
+	bool clear() override;
+
+	size_t packetCount() const override {
+		return packetIndex.size();
+	}
+
+	etl::optional<Time::DefaultCUC> timeTag(size_t position) const override {
+		return packetIndex[position].timeTag;
+	}
+
+	etl::span<const uint8_t> packet(size_t position) const override {
+		const StoredPacket& storedPacket = packetIndex[position];
+		return {packetData.data() + storedPacket.offset, storedPacket.size};
+	}
+
+	uint32_t cumulativeSize(size_t position) const override {
+		if (position == packetIndex.size()) {
+			return cumulativeStoredBytes;
+		}
+		return packetIndex[position].cumulativeSize;
+	}
+
+	uint32_t sizeInBytes() const override {
+		return storedBytes;
+	}
+
+	uint32_t capacityInBytes() const override {
+		return DataCapacity;
+	}
+
+	uint32_t maxPacketSize() const override {
+		return DataCapacity;
+	}
+
+private:
+	/**
+	 * The location of a stored TM packet inside \ref packetData
+	 */
+	struct StoredPacket {
+		/**
+		 * The time-tag assigned to the packet when it was stored
+		 */
+		Time::DefaultCUC timeTag{0};
+		/**
+		 * The position of the first byte of the packet in \ref packetData
+		 */
+		uint16_t offset = 0;
+		/**
+		 * The size of the serialized packet, in bytes
+		 */
+		uint16_t size = 0;
+		/**
+		 * The value of \ref cumulativeStoredBytes right before this packet was stored
+		 */
+		uint32_t cumulativeSize = 0;
+	};
+
+	/**
+	 * The serialized TM packets, one after the other, used as a ring buffer. A packet is never split in two: if it does
+	 * not fit before the end of the buffer, it is written at the start, and the leftover bytes at the end stay unused
+	 * until the buffer wraps around again.
+	 */
+	etl::array<uint8_t, DataCapacity> packetData{};
+
+	/**
+	 * The time-tag and location of every stored packet.
+	 *
+	 * @note This is filled out using `push_back` and emptied using `pop_front`, so that earlier packets are placed in
+	 * the front position.
+	 *
+	 * 				old packets  <---------->  new packets
+	 * 				[][][][][][][][][][][][][][][][][][][]	<--- deque
+	 */
+	etl::deque<StoredPacket, ECSSMaxPacketStoreSize> packetIndex;
+
+	/**
+	 * The number of bytes stored since the backend was created, used for \ref StoredPacket::cumulativeSize
+	 */
+	uint32_t cumulativeStoredBytes = 0;
+
+	/**
+	 * The sum of the sizes of the stored packets, kept up to date on every insertion and removal
+	 */
+	uint16_t storedBytes = 0;
+
+	/**
+	 * The position in \ref packetData right after the newest stored packet
+	 */
+	uint16_t writeOffset = 0;
+
+	/**
+	 * Whether the newest packets have been written at the start of \ref packetData, before the oldest ones
+	 */
+	bool isWrapped = false;
+
+	/**
+	 * Finds where a packet of \p size bytes can be written without overwriting any stored packet
+	 *
+	 * @return true if there is enough room, in which case \p offset is set to the position of the packet
+	 */
+	bool findFreeSpace(uint16_t size, uint16_t& offset) const;
+};
+
+#endif // ECSS_SERVICES_PACKETSTOREBACKEND_HPP
@@ -0,0 +1,62 @@
+#ifndef ECSS_SERVICES_PACKETTIMESTAMPER_HPP
+#define ECSS_SERVICES_PACKETTIMESTAMPER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Time stamping of the secondary header of TM packets.
+ *
+ * The current time is cached as whole seconds since the Unix epoch, plus the fraction of the current second in
+ * units of 2^-32 s (the CUC fine time). The platform refreshes the cache once per tick, either with \ref update,
+ * when it knows the sub-second time, or with \ref refresh, which only reads \ref TimeGetter::getCurrentTimeUTC.
+ * Stamping a packet then copies the cached value, instead of converting the current UTC time for every packet.
+ *
+ * Until the cache is refreshed for the first time, every packet is stamped from \ref TimeGetter::getCurrentTimeUTC
+ * with a zero fine time.
+ *
+ * The cache may be refreshed by a different task than the ones that stamp packets, so it is guarded by a sequence
+ * counter: readers retry when a refresh happened while they were reading.
+ */
+class PacketTimeStamper {
+public:
+	/**
+	 * The size of the time field of the TM secondary header: 4 bytes of seconds and 4 bytes of fine time
+	 */
+	static constexpr uint8_t TimeFieldSize = 8;
+
+	/**
+	 * Sets the cached time
+	 * @param epochSeconds Seconds since the Unix epoch
+	 * @param fineTime The fraction of the current second, in units of 2^-32 s
+	 */
+	static void update(uint32_t epochSeconds, uint32_t fineTime);
+
+	/**
+	 * Sets the cached time from \ref TimeGetter::getCurrentTimeUTC, with a zero fine time
+	 */
+	static void refresh();
+
+	/**
+	 * Converts a number of milliseconds into the current second to a CUC fine time
+	 */
+	static constexpr uint32_t fineTimeFromMilliseconds(uint16_t milliseconds) {
+		return static_cast<uint32_t>((static_cast<uint64_t>(milliseconds) << 32U) / 1000U); // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	}
+
+	/**
+	 * Writes the current time, big-endian, in the \ref TimeFieldSize bytes starting at \p field
+	 */
+	static void writeTimeField(uint8_t* field);
+
+private:
+	inline static std::atomic<uint32_t> sequence{0};
+
+	inline static std::atomic<uint32_t> cachedSeconds{0};
+
+	inline static std::atomic<uint32_t> cachedFineTime{0};
+
+	inline static std::atomic<bool> isCacheValid{false};
+};
+
+#endif // ECSS_SERVICES_PACKETTIMESTAMPER_HPP
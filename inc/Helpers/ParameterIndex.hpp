@@ -0,0 +1,86 @@
+#ifndef ECSS_SERVICES_PARAMETERINDEX_HPP
+#define ECSS_SERVICES_PARAMETERINDEX_HPP
+
+#include <cstdint>
+#include "ECSS_Definitions.hpp"
+#include "MemoryManager.hpp"
+#include "TypeDefinitions.hpp"
+
+/**
+ * Constant-time lookup of the parameters of the spacecraft, by their ID.
+ *
+ * The parameter IDs in \ref PeakSatParameters::allParameterIds are inserted once, along with their type, in an
+ * open-addressing hash table with at most 75% load. Checking whether a parameter exists and finding its type then
+ * takes a hash and, on average, less than two probes, instead of a linear search over all parameters.
+ *
+ * The table is built by \ref build, which the platform calls once at start-up, before the tasks that look up
+ * parameters are started, e.g. together with \ref TimeBasedSchedulingService::initEsotericVariables. It is not built
+ * during static initialisation, because the parameter list is defined in other translation units. Lookups only read
+ * the table, so any task may use them once it is built, with no lock.
+ */
+class ParameterIndex {
+public:
+	/**
+	 * The number of slots of the hash table: the smallest power of two that keeps the load under 75%
+	 */
+	static constexpr uint16_t Capacity = [] {
+		uint32_t capacity = 1U;
+		while ((capacity * 3U) < (ECSSParameterCount * 4U)) {
+			capacity <<= 1U;
+		}
+		return static_cast<uint16_t>(capacity);
+	}();
+
+	/**
+	 * @return True if \p parameterId is one of the parameters of the spacecraft
+	 */
+	static bool parameterExists(ParameterId parameterId) {
+		return findSlot(parameterId) != NotFound;
+	}
+
+	/**
+	 * @return The type of \p parameterId. For unknown parameters, this falls back to the global getParameterType().
+	 */
+	static PARAMETER_TYPE getParameterType(ParameterId parameterId);
+
+	/**
+	 * (Re)builds the table out of the current list of parameters. Parameters beyond \ref ECSSParameterCount are
+	 * reported as an internal error.
+	 *
+	 * If a parameter is looked up before this is called, the table is built then, as a fallback for platforms that
+	 * only look up parameters from a single task.
+	 *
+	 * @warning This must not run while another task looks up a parameter.
+	 */
+	static void build();
+
+private:
+	static constexpr uint16_t NotFound = UINT16_MAX;
+
+	/**
+	 * @return The slot of \p parameterId in the table, or \ref NotFound
+	 */
+	static uint16_t findSlot(ParameterId parameterId);
+
+	/**
+	 * The number of bits of a slot of the table, i.e. log2(\ref Capacity)
+	 */
+	static constexpr uint8_t CapacityBits = [] {
+		uint8_t bits = 0;
+		while ((1U << bits) < Capacity) {
+			bits++;
+		}
+		return bits;
+	}();
+
+	/**
+	 * Fibonacci hashing of a parameter ID to the initial slot to probe. The ID is multiplied by 2^16 / φ modulo 2^16,
+	 * and the slot is the high \ref CapacityBits bits of the product, which depend on all the bits of the ID.
+	 */
+	static uint16_t hash(ParameterId parameterId) {
+		const uint16_t product = static_cast<uint16_t>(static_cast<uint32_t>(parameterId) * 40503U); // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		return static_cast<uint16_t>(static_cast<uint32_t>(product) >> (16U - CapacityBits)); // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	}
+};
+
+#endif // ECSS_SERVICES_PARAMETERINDEX_HPP
@@ -0,0 +1,242 @@
+#ifndef ECSS_SERVICES_PARAMETERMONITORINGENGINE_HPP
+#define ECSS_SERVICES_PARAMETERMONITORINGENGINE_HPP
+
+#include <cstdint>
+#include "CheckTransitionBuffer.hpp"
+#include "ECSS_Definitions.hpp"
+#include "PMON.hpp"
+#include "etl/array.h"
+#include "etl/vector.h"
+
+/**
+ * Batch evaluation of the enabled ST[12] Parameter Monitoring definitions.
+ *
+ * Instead of calling the virtual \ref PMON::performCheck of every definition, the enabled definitions are copied
+ * once into one table per check type, with one array per field (parameter IDs, limits, masks, statuses, repetition
+ * counters, ...). The rows of each table are grouped by monitoring interval, so that the definitions that are due at
+ * the same time are next to each other. Every monitoring cycle then, for each monitoring interval that is due:
+ * 1. reads the values of the monitored parameters, one table after the other
+ * 2. evaluates each check type in a single loop without virtual calls and with few branches, which the compiler can
+ * unroll or vectorise
+ * 3. copies the new statuses and repetition counters back to the \ref PMON definitions, so that the reports of the
+ * service keep reading them from there
+ *
+ * Whenever @ref PMON::repetitionNumber consecutive checks of a definition give a status other than the last recorded
+ * one, the check transition is pushed to a \ref CheckTransitionBuffer, to be reported in TM[12,12].
+ *
+ * The tables only hold copies of the definitions, so they have to be refilled with \ref clear and \ref add whenever
+ * a definition is added, removed, enabled, disabled or modified. They are then rebuilt on the next \ref checkAll.
+ */
+class ParameterMonitoringEngine {
+public:
+	/**
+	 * @param checkTransitions Where the check transitions are pushed. The engine is its only producer.
+	 */
+	explicit ParameterMonitoringEngine(CheckTransitionBuffer& checkTransitions) : checkTransitions(checkTransitions) {}
+
+	/**
+	 * Removes all definitions from the tables
+	 */
+	void clear() {
+		definitions.clear();
+		isBuilt = false;
+	}
+
+	/**
+	 * Adds a definition to the tables. The definition must stay at the same address until the tables are cleared.
+	 *
+	 * @param pmonId The ID of the definition, used in its check transitions
+	 */
+	void add(ParameterId pmonId, PMON& definition) {
+		definitions.push_back(StagedDefinition{pmonId, &definition});
+		isBuilt = false;
+	}
+
+	/**
+	 * Starts a new minimum sampling interval: evaluates the definitions whose monitoring interval is due, and updates
+	 * their checking status and repetition counter. This is meant to be called once every
+	 * \ref ECSSMonitoringFrequency.
+	 */
+	void checkAll();
+
+	/**
+	 * Returns the number of definitions in the tables
+	 */
+	uint16_t size() const {
+		return definitions.size();
+	}
+
+private:
+	/**
+	 * A definition added since the last \ref clear
+	 */
+	struct StagedDefinition {
+		ParameterId pmonId;
+		PMON* definition;
+	};
+
+	/**
+	 * A range of consecutive rows of a table
+	 */
+	struct RowRange {
+		uint16_t begin = 0;
+		uint16_t end = 0;
+	};
+
+	/**
+	 * The rows of the definitions with the same monitoring interval, in each table
+	 */
+	struct IntervalBucket {
+		PMONMonitoringInterval interval = 1;
+		RowRange limitChecks;
+		RowRange expectedValueChecks;
+		RowRange deltaChecks;
+	};
+
+	struct LimitCheckTable {
+		uint16_t size = 0;
+		etl::array<PMONLimitCheck*, ECSSMaxLimitCheckDefinitions> definitions{};
+		etl::array<ParameterId, ECSSMaxLimitCheckDefinitions> pmonIds{};
+		etl::array<ParameterId, ECSSMaxLimitCheckDefinitions> parameterIds{};
+		etl::array<PMONLimit, ECSSMaxLimitCheckDefinitions> lowLimits{};
+		etl::array<PMONLimit, ECSSMaxLimitCheckDefinitions> highLimits{};
+		etl::array<double, ECSSMaxLimitCheckDefinitions> values{};
+		etl::array<bool, ECSSMaxLimitCheckDefinitions> isValueValid{};
+		etl::array<PMON::CheckingStatus, ECSSMaxLimitCheckDefinitions> statuses{};
+		etl::array<PMONRepetitionNumber, ECSSMaxLimitCheckDefinitions> repetitionCounters{};
+		etl::array<PMONRepetitionNumber, ECSSMaxLimitCheckDefinitions> repetitionNumbers{};
+		/**
+		 * The current status of the last check transition of each definition
+		 */
+		etl::array<PMON::CheckingStatus, ECSSMaxLimitCheckDefinitions> transitionStatuses{};
+	};
+
+	struct ExpectedValueCheckTable {
+		uint16_t size = 0;
+		etl::array<PMONExpectedValueCheck*, ECSSMaxExpectedValueCheckDefinitions> definitions{};
+		etl::array<ParameterId, ECSSMaxExpectedValueCheckDefinitions> pmonIds{};
+		etl::array<ParameterId, ECSSMaxExpectedValueCheckDefinitions> parameterIds{};
+		etl::array<PMONBitMask, ECSSMaxExpectedValueCheckDefinitions> masks{};
+		etl::array<PMONExpectedValue, ECSSMaxExpectedValueCheckDefinitions> expectedValues{};
+		etl::array<uint64_t, ECSSMaxExpectedValueCheckDefinitions> values{};
+		etl::array<bool, ECSSMaxExpectedValueCheckDefinitions> isValueValid{};
+		etl::array<PMON::CheckingStatus, ECSSMaxExpectedValueCheckDefinitions> statuses{};
+		etl::array<PMONRepetitionNumber, ECSSMaxExpectedValueCheckDefinitions> repetitionCounters{};
+		etl::array<PMONRepetitionNumber, ECSSMaxExpectedValueCheckDefinitions> repetitionNumbers{};
+		/**
+		 * The current status of the last check transition of each definition
+		 */
+		etl::array<PMON::CheckingStatus, ECSSMaxExpectedValueCheckDefinitions> transitionStatuses{};
+	};
+
+	struct DeltaCheckTable {
+		uint16_t size = 0;
+		etl::array<PMONDeltaCheck*, ECSSMaxDeltaCheckDefinitions> definitions{};
+		etl::array<ParameterId, ECSSMaxDeltaCheckDefinitions> pmonIds{};
+		etl::array<ParameterId, ECSSMaxDeltaCheckDefinitions> parameterIds{};
+		etl::array<DeltaThreshold, ECSSMaxDeltaCheckDefinitions> lowThresholds{};
+		etl::array<DeltaThreshold, ECSSMaxDeltaCheckDefinitions> highThresholds{};
+		etl::array<double, ECSSMaxDeltaCheckDefinitions> values{};
+		etl::array<bool, ECSSMaxDeltaCheckDefinitions> isValueValid{};
+		etl::array<PMON::CheckingStatus, ECSSMaxDeltaCheckDefinitions> statuses{};
+		etl::array<PMONRepetitionNumber, ECSSMaxDeltaCheckDefinitions> repetitionCounters{};
+		etl::array<PMONRepetitionNumber, ECSSMaxDeltaCheckDefinitions> repetitionNumbers{};
+		/**
+		 * The current status of the last check transition of each definition
+		 */
+		etl::array<PMON::CheckingStatus, ECSSMaxDeltaCheckDefinitions> transitionStatuses{};
+	};
+
+	/**
+	 * The definitions added since the last \ref clear
+	 */
+	etl::vector<StagedDefinition, ECSSMaxMonitoringDefinitions> definitions;
+
+	CheckTransitionBuffer& checkTransitions;
+
+	/**
+	 * Whether the tables and the buckets hold the current \ref definitions
+	 */
+	bool isBuilt = false;
+
+	/**
+	 * The number of calls to \ref checkAll so far. A monitoring interval is due when it divides this.
+	 */
+	uint32_t tick = 0;
+
+	/**
+	 * The monitoring intervals of the definitions, in increasing order
+	 */
+	etl::vector<IntervalBucket, ECSSMaxMonitoringIntervals> buckets;
+
+	LimitCheckTable limitChecks;
+
+	ExpectedValueCheckTable expectedValueChecks;
+
+	DeltaCheckTable deltaChecks;
+
+	/**
+	 * Fills the tables with \ref definitions, grouped by monitoring interval
+	 */
+	void build();
+
+	/**
+	 * Appends a row with \p definition to the table of its check type
+	 */
+	void addRow(ParameterId pmonId, PMON& definition);
+
+	/**
+	 * Reads the current value of every monitored parameter of \p bucket into the tables
+	 */
+	void gatherValues(const IntervalBucket& bucket);
+
+	/*
+	 * The evaluation of each check type. \p now is the time of the current cycle, read once per cycle and used as the
+	 * time of all the values read in \ref gatherValues.
+	 */
+
+	void evaluateLimitChecks(RowRange rows, Time::DefaultCUC now);
+
+	void evaluateExpectedValueChecks(RowRange rows, Time::DefaultCUC now);
+
+	/**
+	 * @copydoc evaluateLimitChecks
+	 *
+	 * The samples of the delta checks are kept by the \ref PMONDeltaCheck definitions, so they are updated directly.
+	 */
+	void evaluateDeltaChecks(RowRange rows, Time::DefaultCUC now);
+
+	/**
+	 * Copies the statuses and repetition counters of the rows of \p bucket back to the definitions
+	 */
+	void storeResults(const IntervalBucket& bucket);
+
+	/**
+	 * Completes \p transition from \p definition to the new \p status, pushes it to \ref checkTransitions, and records
+	 * \p status as the current status of the last check transition.
+	 *
+	 * @param transitionStatus The entry of the table with the current status of the last check transition
+	 */
+	void recordTransition(ParameterId pmonId, PMON& definition, PMON::CheckingStatus& transitionStatus,
+	                      PMON::CheckingStatus status, Time::DefaultCUC now, CheckTransition& transition);
+
+	/**
+	 * Returns whether a check with result \p status is a check transition: the status differs from the current status
+	 * of the last transition, \p transitionStatus, and has been the result of the last \p repetitionNumber checks.
+	 */
+	static bool isTransition(PMON::CheckingStatus transitionStatus, PMON::CheckingStatus status,
+	                         PMONRepetitionNumber repetitionCounter, PMONRepetitionNumber repetitionNumber) {
+		return (status != transitionStatus) and (repetitionCounter >= repetitionNumber);
+	}
+
+	/**
+	 * Returns the repetition counter after a check with result \p status: the counter is incremented if the status is
+	 * the same as \p previousStatus, and reset to 1 otherwise.
+	 */
+	static PMONRepetitionNumber countRepetition(PMON::CheckingStatus previousStatus, PMON::CheckingStatus status,
+	                                            PMONRepetitionNumber repetitionCounter) {
+		return static_cast<PMONRepetitionNumber>(repetitionCounter * static_cast<uint16_t>(status == previousStatus) + 1U);
+	}
+};
+
+#endif // ECSS_SERVICES_PARAMETERMONITORINGENGINE_HPP
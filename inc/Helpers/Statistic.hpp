@@ -5,23 +5,45 @@
 #include "ErrorHandler.hpp"
 #include "Service.hpp"
 #include "TimeGetter.hpp"
+#include "etl/span.h"
 #include "etl/vector.h"
 
 /**
  * Class containing all the statistics for every parameter. Includes functions that calculate and append the
  * statistics to messages
+ *
+ * The mean and the variance are accumulated with Welford's algorithm: the mean is updated with the deviation of each
+ * sample from it, and the sum of the squared deviations from the mean is accumulated instead of the sum of squares.
+ * This avoids subtracting two large, nearly equal numbers when the standard deviation is computed, which loses most
+ * of the precision when the mean is large compared to the standard deviation, or after many samples.
  */
 class Statistic {
 public:
 	SamplingInterval selfSamplingInterval = 0;
+
+	/**
+	 * The number of samples, as reported in TM[4,2]. It stops at the largest \ref ParameterSampleCount instead of
+	 * wrapping around.
+	 */
 	ParameterSampleCount sampleCounter = 0;
+
 	Time::DefaultCUC timeOfMaxValue;
 	Time::DefaultCUC timeOfMinValue;
 	double max = -std::numeric_limits<double>::infinity();
 	double min = std::numeric_limits<double>::infinity();
-	double sumOfSquares = 0;
+
+	/**
+	 * The number of samples in \ref mean and \ref sumOfSquaredDeviations
+	 */
+	uint32_t accumulatedSamples = 0;
+
 	double mean = 0;
 
+	/**
+	 * The sum of the squares of the deviations of the samples from \ref mean
+	 */
+	double sumOfSquaredDeviations = 0;
+
 	Statistic() = default;
 
 	/**
@@ -30,6 +52,16 @@ public:
 	 */
 	void updateStatistics(double value);
 
+	/**
+	 * Updates the statistics with a block of samples, without storing them. This gives the same result as calling
+	 * \ref updateStatistics for each sample, up to rounding. The block is summed in two loops without divisions or
+	 * clock reads, and then merged in the accumulated statistics with a single division.
+	 *
+	 * @param values The samples, in the order in which they were taken. The time of the maximum and minimum value is
+	 * the time of the call.
+	 */
+	void updateStatistics(etl::span<const double> values);
+
 	/**
 	 * Resets all statistics calculated to default values
 	 */
@@ -29,6 +29,10 @@ using PacketStoreType = uint8_t;
  */
 using VirtualChannel = uint8_t;
 using NumOfPacketStores = uint16_t;
+/**
+ * The index of a packet store inside the Storage and Retrieval Service, assigned when the packet store is created.
+ */
+using PacketStoreHandle = uint8_t;
 using ApplicationProcessId = uint16_t;
 /**
  * The types used for the numerical representation of service and message types.
@@ -56,3 +60,8 @@ using ECSSErrorCode = uint16_t;
  using PMONBitMask = uint64_t;
  using NumberOfConsecutiveDeltaChecks = uint16_t;
  using DeltaThreshold = double;
+/**
+ * The interval between two checks of a PMON definition, expressed as units of the minimum sampling interval
+ * ECSSMonitoringFrequency.
+ */
+ using PMONMonitoringInterval = uint16_t;
@@ -1,10 +1,13 @@
 #ifndef ECSS_SERVICES_MESSAGEPARSER_HPP
 #define ECSS_SERVICES_MESSAGEPARSER_HPP
 #include <etl/expected.h>
+#include <etl/span.h>
+#include <etl/vector.h>
 
 
 #include "ErrorDefinitions.hpp"
 #include "Message.hpp"
+#include "MessageView.hpp"
 
 /**
  * A generic class responsible for the execution and the parsing of the incoming telemetry and telecommand
@@ -45,6 +48,35 @@ public:
 	 */
 	static void execute(Message& message);
 
+	/**
+	 * The per-packet results of \ref MessageParser::parseAndExecuteBatch()
+	 */
+	using BatchStatus = etl::vector<SpacecraftErrorCode, ECSSMaxTCBatchSize>;
+
+	/**
+	 * Parse and execute a burst of TC packets that have been received in a single transfer
+	 *
+	 * \p data holds several CCSDS packets back to back. The packets are split using the packet data length field of
+	 * each primary header, and their CRCs (if enabled) are all validated first, in one pass over the buffer. Every
+	 * valid packet is then parsed and dispatched through \ref MessageParser::execute(), in the order it was received.
+	 *
+	 * A packet with a wrong CRC gets the OBDH_ERROR_INVALID_ARGUMENT status and is not executed. Splitting stops at
+	 * the first packet that does not fit in the rest of the buffer, or after \ref ECSSMaxTCBatchSize packets. In the
+	 * latter case the rest of the buffer is left for the caller, which can pass it to another call starting at
+	 * \p consumedLength.
+	 *
+	 * @param data The concatenated CCSDS packets (not null-terminated)
+	 * @param length The size of \p data
+	 * @param error_reporting_active Passed on to \ref MessageParser::parse()
+	 * @param consumedLength Set to the number of bytes of \p data taken by the packets in the returned status. It is
+	 * less than \p length if more than \ref ECSSMaxTCBatchSize packets were received, or if the last packet is
+	 * incomplete.
+	 * @return The status of each packet found in \p data, in order. GENERIC_ERROR_NONE means that the packet was
+	 * dispatched; errors during its execution are reported by the services themselves.
+	 */
+	static BatchStatus parseAndExecuteBatch(const uint8_t* data, uint32_t length, bool error_reporting_active,
+	                                        uint32_t& consumedLength);
+
 	/**
 	 * Parse a message that contains the CCSDS and ECSS packet headers, as well as the data
 	 *
@@ -56,6 +88,21 @@ public:
 	 */
     static SpacecraftErrorCode parse(const uint8_t* data, uint32_t length, Message& message, bool error_reporting_active, bool parse_ccsds);
 
+	/**
+	 * Validate the CCSDS and ECSS headers of a packet in place, without copying anything
+	 *
+	 * The headers are decoded straight from \p data, and \p view is set to point to the user data field within \p data.
+	 * This is the zero-copy alternative to \ref MessageParser::parse(), for callers that can consume the packet before
+	 * the receive buffer is reused.
+	 *
+	 * @param data The CCSDS packet, starting from the primary header (not null-terminated)
+	 * @param length The size of the packet
+	 * @param view The view to fill in. It is only valid as long as \p data is.
+	 * @param error_reporting_active Whether the CCSDS version, secondary header flag and sequence flags are checked
+	 * @return GENERIC_ERROR_NONE if the packet headers are valid
+	 */
+	static SpacecraftErrorCode parseView(const uint8_t* data, uint32_t length, MessageView& view, bool error_reporting_active);
+
 	/**
 	 * Parse data that contains the ECSS packet header, without the CCSDS space packet header
 	 *
@@ -90,6 +137,18 @@ public:
 	 */
     static etl::expected<String<CCSDSMaxMessageSize>, SpacecraftErrorCode> compose( Message& message, uint16_t size);
 
+	/**
+	 * @brief Serializes a TC or TM message as a complete CCSDS packet straight into \p out
+	 * @details The primary header, the secondary header, the user data field and (if enabled) the CRC are written in
+	 * a single pass, without any intermediate buffers. The CRC is updated as each part is written.
+	 * @param message The Message object to be serialized
+	 * @param size The wanted size of the ECSS part of the packet (secondary header and user data field). The user data
+	 * field is padded with zeros up to this size.
+	 * @param out The destination buffer. It must fit the whole packet, including the CRC.
+	 * @return The number of bytes written to \p out
+	 */
+	static etl::expected<uint16_t, SpacecraftErrorCode> compose(Message& message, uint16_t size, etl::span<uint8_t> out);
+
 
     /**
  * Parse the ECSS Telecommand packet secondary header
@@ -120,6 +179,13 @@ private:
 	 */
 	static constexpr CRCSize CRCField = 2U;
 
+	/**
+	 * Writes the ECSS TC or TM secondary header of \p message to \p header
+	 * @param header The destination, with room for at least \ref ECSSSecondaryTMHeaderSize bytes
+	 * @return The number of bytes written
+	 */
+	static uint16_t writeECSSHeader(const Message& message, uint8_t* header);
+
 };
 
 #endif // ECSS_SERVICES_MESSAGEPARSER_HPP
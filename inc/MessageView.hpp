@@ -0,0 +1,48 @@
+#ifndef ECSS_SERVICES_MESSAGEVIEW_HPP
+#define ECSS_SERVICES_MESSAGEVIEW_HPP
+
+#include <cstdint>
+#include "Message.hpp"
+#include "TypeDefinitions.hpp"
+
+/**
+ * A lightweight, non-owning view of a received CCSDS/ECSS packet
+ *
+ * This is the output of \ref MessageParser::parseView(). It contains the decoded header fields, while the user data
+ * field is not copied; \ref MessageView::data points straight into the buffer that was passed to the parser. The view
+ * is only valid for as long as that buffer is alive and unchanged.
+ *
+ * The member names mirror the ones of \ref Message, so that a view can be turned into a Message with a single copy
+ * of the user data field, as \ref MessageParser::parse() does.
+ */
+struct MessageView {
+	ServiceTypeNum serviceType = 0;
+	MessageTypeNum messageType = 0;
+
+	Message::PacketType packet_type_ = Message::UNDEFINED;
+
+	/**
+	 * The 2 most significant bits of the APID of the packet
+	 */
+	ApplicationProcessId application_ID_ = 0;
+
+	/**
+	 * The source ID of a TC. Always 0 for a TM.
+	 */
+	SourceId source_ID_ = 0;
+
+	SequenceCount packet_sequence_count_ = 0;
+
+	uint16_t total_size_ccsds_ = 0;
+
+	uint16_t total_size_ecss_ = 0;
+
+	uint16_t data_size_ecss_ = 0;
+
+	/**
+	 * Pointer to the first byte of the user data field, i.e. right after the ECSS secondary header
+	 */
+	const uint8_t* data = nullptr;
+};
+
+#endif // ECSS_SERVICES_MESSAGEVIEW_HPP
@@ -216,17 +216,71 @@ public:
 	 * This function calculates the time needed to pass until the next periodic report for each housekeeping 
 	 * structure. The function also calls the housekeeping reporting functions as needed.
 	 *
+	 * @param elapsed_time_s Seconds elapsed since the previous call
+	 * @return Seconds until the next report is due, rounded up
 	 */
 	uint32_t reportPendingStructures(uint32_t elapsed_time_s);
 
+	/**
+	 * Millisecond version of \ref reportPendingStructures, for sub-second collection intervals.
+	 *
+	 * The enabled structures are kept in a min-heap keyed on the time of their next report, so each call only touches
+	 * the structures that are due. Disabled structures cost nothing.
+	 *
+	 * @param elapsed_time_ms Milliseconds elapsed since the previous call
+	 * @return Milliseconds until the next report is due, see \ref getTimeUntilNextReportMs
+	 */
+	uint64_t reportPendingStructuresMs(uint64_t elapsed_time_ms);
+
+	/**
+	 * @return Milliseconds until the next periodic report is due. If no structure is periodically reported, this is
+	 * one minimum sampling interval, so that a polling task still notices structures that get enabled later.
+	 */
+	static uint64_t getTimeUntilNextReportMs();
+
 	static void readHousekeepingStruct(uint8_t struct_offset, HousekeepingStructure& structure);
 
+	/**
+	 * Stores \p structure in the slot \p struct_offset, first in MRAM and then in the RAM mirror. If the MRAM write
+	 * fails, the error is logged and the RAM mirror keeps the previous structure of the slot, so that both agree.
+	 */
 	static void updateHouseKeepingStruct(uint8_t struct_offset, HousekeepingStructure structure);
 
+	/**
+	 * Finds a housekeeping structure by its ID. The lookup is served by the RAM mirror of the structures and never
+	 * reads from MRAM.
+	 * @param structure_id Housekeeping structure ID
+	 * @param structure Set to the found structure
+	 * @return The slot of the structure, or -1 if no structure has this ID
+	 */
 	static int getHousekeepingStructureById(uint16_t structure_id, HousekeepingStructure& structure);
 
+	/**
+	 * Loads all housekeeping structures from MRAM into the RAM mirror and restarts their collection timers.
+	 */
 	void initialiseHousekeepingTimers();
 
+	/**
+	 * Reads every housekeeping structure slot from MRAM into the RAM mirror, and rebuilds the ID to slot index.
+	 * All later lookups are served from RAM, while \ref updateHouseKeepingStruct writes through to MRAM.
+	 * The periodic reports of all enabled structures are scheduled one collection interval from now.
+	 */
+	static void loadHousekeepingStructCache();
+
+	/**
+	 * Takes the lock of the RAM mirror, the ID to slot index, the report plans and the report schedule. These are
+	 * changed by TC[3,x] requests and read by the task that calls \ref reportPendingStructuresMs, which may differ.
+	 * @note This function should be reimplemented by the platform, e.g. with a mutex, or left empty when a single task
+	 * runs the service. The lock is never held during an MRAM access, so it may be the mutex that guards the MRAM.
+	 */
+	static void lockHousekeepingState();
+
+	/**
+	 * Releases the lock taken by \ref lockHousekeepingState.
+	 * @note This function should be reimplemented by the platform.
+	 */
+	static void unlockHousekeepingState();
+
 	/**
 	 * It is responsible to call the suitable function that executes a TC packet. The source of that packet
 	 * is the ground station.
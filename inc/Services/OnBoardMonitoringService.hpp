@@ -1,14 +1,17 @@
 #ifndef ECSS_SERVICES_ONBOARDMONITORINGSERVICE_HPP
 #define ECSS_SERVICES_ONBOARDMONITORINGSERVICE_HPP
 #include <cstdint>
+#include "CheckTransitionBuffer.hpp"
 #include "ECSS_Definitions.hpp"
 #include "Message.hpp"
 #include "PMON.hpp"
+#include "ParameterMonitoringEngine.hpp"
 #include "Service.hpp"
 #include "etl/array.h"
 #include "etl/functional.h"
 #include "etl/list.h"
 #include "etl/map.h"
+#include "etl/pool.h"
 #include "etl/vector.h"
 
 /**
@@ -21,44 +24,92 @@ private:
 	/**
 	 * Maximum number of checks for each Limit Check.
 	 */
-	static constexpr uint8_t MaximumNumberOfChecksLimitCheck = 10;
+	static constexpr uint16_t MaximumNumberOfChecksLimitCheck = ECSSMaxLimitCheckDefinitions;
 
 	/**
 	 * Maximum number of checks for each Expected Value Check.
 	 */
-	static constexpr uint8_t MaximumNumberOfChecksExpectedValueCheck = 4;
+	static constexpr uint16_t MaximumNumberOfChecksExpectedValueCheck = ECSSMaxExpectedValueCheckDefinitions;
 
 	/**
 	 * Maximum number of checks for each Delta check.
 	 */
-	static constexpr uint8_t MaximumNumberOfChecksDeltaCheck = 1;
+	static constexpr uint16_t MaximumNumberOfChecksDeltaCheck = ECSSMaxDeltaCheckDefinitions;
 
 	/**
-	 * This vector is used as a mean of storing the PMON Definitons
-	 * resulting from the addParameterMonitoringDefinitions method according to their Check Type
-	 * before they are added to the parameterMonitoringList.
+	 * The storage of the PMON Definitions of each Check Type, referenced by the parameterMonitoringList.
+	 *
+	 * A definition keeps its address until it is deleted, so adding or deleting other definitions never invalidates
+	 * the references held in the parameterMonitoringList, and a deleted definition frees its slot for a new one.
 	 */
-	etl::vector<PMONLimitCheck, MaximumNumberOfChecksLimitCheck> limitChecks;
+	etl::pool<PMONLimitCheck, MaximumNumberOfChecksLimitCheck> limitChecks;
 
 	/**
-	 * This vector is used as a mean of storing the PMON Definitons
-	 * resulting from the addParameterMonitoringDefinitions method according to their Check Type
-	 * before they are added to the parameterMonitoringList.
+	 * @copydoc limitChecks
 	 */
-	etl::vector<PMONExpectedValueCheck, MaximumNumberOfChecksExpectedValueCheck> expectedValueChecks;
+	etl::pool<PMONExpectedValueCheck, MaximumNumberOfChecksExpectedValueCheck> expectedValueChecks;
 
 	/**
-	 * This vector is used as a mean of storing the PMON Definitons
-	 * resulting from the addParameterMonitoringDefinitions method according to their Check Type
-	 * before they are added to the parameterMonitoringList.
+	 * @copydoc limitChecks
 	 */
-	etl::vector<PMONDeltaCheck, MaximumNumberOfChecksDeltaCheck> deltaChecks;
+	etl::pool<PMONDeltaCheck, MaximumNumberOfChecksDeltaCheck> deltaChecks;
+
+	/**
+	 * The check transitions that have not been reported yet, pushed by \ref monitoringEngine and drained by
+	 * \ref checkTransitionReport. Both run in \ref checkAll, so the task that calls \ref checkAll owns both sides.
+	 */
+	CheckTransitionBuffer checkTransitions;
+
+	/**
+	 * The tables of the enabled PMON definitions, evaluated by \ref checkAll
+	 */
+	ParameterMonitoringEngine monitoringEngine{checkTransitions};
+
+	/**
+	 * The number of minimum sampling intervals since the oldest check transition that has not been reported
+	 */
+	uint16_t checkTransitionAge = 0;
+
+	/**
+	 * The maximum number of check transitions in a TM[12,12] report, with the largest fields of all check types
+	 */
+	static constexpr uint16_t MaxTransitionsPerReport =
+	    (ECSSMaxMessageSize - sizeof(uint16_t)) /
+	    (2 * sizeof(ParameterId) + sizeof(PMON::CheckType) + sizeof(PMONBitMask) + 2 * sizeof(uint64_t) +
+	     2 * sizeof(PMON::CheckingStatus) + sizeof(uint32_t));
+
+	/**
+	 * Whether the PMON definitions may have changed since \ref monitoringEngine was last filled, in which case its
+	 * tables are rebuilt before the next check.
+	 */
+	bool areMonitoringTablesOutdated = true;
 
 	/**
 	 * Initialize the ParameterMonitoringList map with default definitions.
 	 */
 	void initializeParameterMonitoringMap();
 
+	/**
+	 * TM[12,12]
+	 * Reports the check transitions that have not been reported yet, in as few reports as possible.
+	 *
+	 * @note This pops the transitions from \ref checkTransitions, so it is only called by \ref checkAll, which is then
+	 * the single consumer of the buffer.
+	 */
+	void checkTransitionReport();
+
+	/**
+	 * Returns the storage of a PMON definition to the pool of its Check Type. The definition must already be removed
+	 * from the parameterMonitoringList.
+	 */
+	void releasePMONDefinition(PMON& definition);
+
+	/**
+	 * Checks whether a new definition can use \p monitoringInterval: it must not be 0, and it must either be already
+	 * in use or there must be fewer than @ref ECSSMaxMonitoringIntervals different intervals in use.
+	 */
+	bool isMonitoringIntervalAvailable(PMONMonitoringInterval monitoringInterval) const;
+
 public:
 	/**
 	 * Map storing the parameter monitoring definitions.
@@ -103,8 +154,11 @@ public:
 	 * Adds a new Parameter Monitoring Limit Check to the parameter monitoring list.
 	 */
 	void addPMONLimitCheck(ParameterId PMONId, PMONLimitCheck& limitCheck) {
-		limitChecks.push_back(limitCheck);
-		parameterMonitoringList.insert(etl::pair<const ParameterId, etl::reference_wrapper<PMON>>(PMONId, etl::ref(limitChecks.back())));
+		if (not ASSERT_INTERNAL(not limitChecks.full(), ErrorHandler::InternalErrorType::MapFull)) {
+			return;
+		}
+		areMonitoringTablesOutdated = true;
+		parameterMonitoringList.insert(etl::pair<const ParameterId, etl::reference_wrapper<PMON>>(PMONId, etl::ref(*limitChecks.create(limitCheck))));
 	}
 
 
@@ -112,30 +166,38 @@ public:
 	 * Adds a new Parameter Monitoring Expected Value Check to the parameter monitoring list.
 	 */
 	void addPMONExpectedValueCheck(ParameterId PMONId, PMONExpectedValueCheck& expectedValueCheck) {
-		expectedValueChecks.push_back(expectedValueCheck);
-		parameterMonitoringList.insert(etl::pair<const ParameterId, etl::reference_wrapper<PMON>>(PMONId, etl::ref(expectedValueChecks.back())));
+		if (not ASSERT_INTERNAL(not expectedValueChecks.full(), ErrorHandler::InternalErrorType::MapFull)) {
+			return;
+		}
+		areMonitoringTablesOutdated = true;
+		parameterMonitoringList.insert(etl::pair<const ParameterId, etl::reference_wrapper<PMON>>(PMONId, etl::ref(*expectedValueChecks.create(expectedValueCheck))));
 	}
 
 	/**
 	 * Adds a new Parameter Monitoring Delta Check to the parameter monitoring list.
 	 */
 	void addPMONDeltaCheck(ParameterId PMONId, PMONDeltaCheck& deltaCheck) {
-		deltaChecks.push_back(deltaCheck);
-		parameterMonitoringList.insert(etl::pair<const ParameterId, etl::reference_wrapper<PMON>>(PMONId, etl::ref(deltaChecks.back())));
+		if (not ASSERT_INTERNAL(not deltaChecks.full(), ErrorHandler::InternalErrorType::MapFull)) {
+			return;
+		}
+		areMonitoringTablesOutdated = true;
+		parameterMonitoringList.insert(etl::pair<const ParameterId, etl::reference_wrapper<PMON>>(PMONId, etl::ref(*deltaChecks.create(deltaCheck))));
 	}
 
 	/**
-	 * This function clears the Parameter Monitoring List map.
+	 * This function clears the Parameter Monitoring List map, and releases the storage of all definitions.
 	 */
-	void clearParameterMonitoringList() {
-		parameterMonitoringList.clear();
-	}
+	void clearParameterMonitoringList();
 
 	/**
 	 * @param PMONId
 	 * @return Parameter Monitoring definition
+	 *
+	 * @note The definition may be modified through the returned reference, so the monitoring tables are rebuilt before
+	 * the next check.
 	 */
 	etl::reference_wrapper<PMON> getPMONDefinition(ParameterId PMONId) {
+		areMonitoringTablesOutdated = true;
 		return parameterMonitoringList.at(PMONId);
 	}
 
@@ -154,11 +216,19 @@ public:
 	}
 
 	/**
-	 * Checks all PMON objects in the parameter monitoring list if they are enabled.
-	 * This function iterates through all PMON objects in the parameter monitoring list
-	 * and calls the performCheck method for each enabled PMON.
+	 * Checks the enabled PMON objects in the parameter monitoring list whose monitoring interval is due. This is meant
+	 * to be called once every @ref ECSSMonitoringFrequency, which is the minimum sampling interval.
+	 *
+	 * The definitions with the same monitoring interval are evaluated in batches, one per check type, by
+	 * \ref ParameterMonitoringEngine. The result is the same as calling \ref PMON::performCheck on each of them.
+	 *
+	 * The check transitions are then reported in TM[12,12], once the oldest one has waited for
+	 * @ref maximumTransitionReportingDelay, or once there are @ref ECSSCheckTransitionsHighWaterMark of them.
+	 *
+	 * @note This is the only function that produces or consumes check transitions, so it must always be called by the
+	 * same task.
 	 */
-	void checkAll() const;
+	void checkAll();
 
 	/**
 	 * Enables the PMON definitions which correspond to the ids in TC[12,1].
@@ -218,9 +288,11 @@ public:
 	void outOfLimitsReport();
 
 	/**
-	 * TM[12,12]
+	 * Returns the number of check transitions that could not be reported, because too many of them were waiting
 	 */
-	void checkTransitionReport();
+	uint32_t getDroppedCheckTransitions() const {
+		return checkTransitions.getDroppedTransitions();
+	}
 
 	/**
 	 * TC[12,13]
@@ -235,4 +307,7 @@ public:
 	void execute(Message& message);
 };
 
+static_assert(sizeof(OnBoardMonitoringService) <= ECSSMonitoringMemoryBudget,
+              "The ST[12] definitions, tables and pools must fit in ECSSMonitoringMemoryBudget");
+
 #endif // ECSS_SERVICES_ONBOARDMONITORINGSERVICE_HPP
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "ErrorHandler.hpp"
 #include "Service.hpp"
 #include "MemoryManager.hpp"
+#include "ParameterIndex.hpp"
 #include "etl/map.h"
 
 /**
@@ -24,7 +25,12 @@
  */
 class ParameterService : public Service {
 private:
-
+	/**
+	 * Writes the number of parameters in the reserved first field of a TM[20,2] report, and stores it
+	 * @param report The report, starting with a placeholder for the number of parameters
+	 * @param numberOfIds The number of (ID, value) pairs contained in the report
+	 */
+	static void storeParameterValuesReport(Message& report, uint16_t numberOfIds);
 
 public:
 	inline static constexpr ServiceTypeNum ServiceType = 20;
@@ -35,10 +41,6 @@ public:
 		SetParameterValues = 3,
 	};
 
-	/**
-	 * The Constructor initializes \var parameters
-	 * by calling \fn initializeParametersArray
-	 */
 	ParameterService() {
 		serviceType = ServiceType;
 	}
@@ -51,12 +53,7 @@ public:
 	 * @return True if there is a reference to a parameter with the given ID, False otherwise
 	 */
 	static bool parameterExists(ParameterId parameterId) {
-		for (int i=0; i < PeakSatParameters::parametersArraySize;i++) {
-			if (PeakSatParameters::allParameterIds[i] == parameterId) {
-				return true;
-			}
-		}
-		return false;
+		return ParameterIndex::parameterExists(parameterId);
 	}
 
 
@@ -65,6 +62,10 @@ public:
 	 * containing the current configuration
 	 * **for the parameters specified in the carried valid IDs**.
 	 *
+	 * The requested IDs are validated and appended in a single pass. Invalid IDs are skipped. When the next value
+	 * would not fit in \ref ECSSMaxMessageSize, the report is stored and the rest of the parameters continue in a new
+	 * TM[20, 2], so requests of any length are served by as many reports as needed.
+	 *
 	 * @param paramId: a TC[20, 1] packet carrying the requested parameter IDs
 	 * @return None (messages are stored using storeMessage())
 	 */
@@ -79,6 +80,42 @@ public:
 	 */
 	void setParameters(Message& newParamValues);
 
+	/**
+	 * A function that reads a parameter of a known type and appends it to a message
+	 */
+	using ParameterEncoder = void (*)(Message& message, ParameterId parameter);
+
+	/**
+	 * How a parameter is serialized, resolved once from its type
+	 */
+	struct ParameterEncoding {
+		/**
+		 * The function that appends the parameter, or nullptr if its type is unknown
+		 */
+		ParameterEncoder encoder = nullptr;
+
+		/**
+		 * The number of bytes that the encoder appends
+		 */
+		uint8_t width = 0;
+	};
+
+	/**
+	 * Resolves the type of a parameter into the function that appends it to a message. Callers that append the same
+	 * parameters repeatedly can keep the result, and skip the type lookup on every append.
+	 */
+	static ParameterEncoding getParameterEncoding(ParameterId parameter);
+
+	/**
+	 * Reads a parameter whose type is already known to be \p T, and appends it to \p message
+	 */
+	template <typename T>
+	static void appendTypedParameter(Message& message, ParameterId parameter) {
+		T temp = 0;
+		MemoryManager::getParameter(parameter, &temp);
+		message.append(temp);
+	}
+
 	void appendParameterToMessage(Message& message, ParameterId parameter);
 
 	void updateParameterFromMessage(Message& message, ParameterId parameter);
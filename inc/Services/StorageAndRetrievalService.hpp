@@ -5,7 +5,9 @@
 #include "ErrorHandler.hpp"
 #include "PacketStore.hpp"
 #include "Service.hpp"
+#include "etl/array.h"
 #include "etl/map.h"
+#include "etl/optional.h"
 
 /**
  * Implementation of ST[15] Storage and Retrieval Service, as defined in ECSS-E-ST-70-41C.
@@ -40,9 +42,23 @@ private:
 	typedef String<ECSSPacketStoreIdSize> packetStoreId;
 
 	/**
-	 * All packet stores, held by the Storage and Retrieval Service. Each packet store has its ID as key.
+	 * The handle of every packet store, with the packet store ID as key. A packet store ID is only looked up here once
+	 * per request; the packet store is then accessed by its handle.
 	 */
-	etl::map<packetStoreId, PacketStore, ECSSMaxPacketStores> packetStores;
+	etl::map<packetStoreId, PacketStoreHandle, ECSSMaxPacketStores> packetStoreHandles;
+
+	/**
+	 * All packet stores, held by the Storage and Retrieval Service, with their handle as index. Only the packet stores
+	 * whose handle is in \ref packetStoreHandles exist.
+	 */
+	etl::array<PacketStore, ECSSMaxPacketStores> packetStores;
+
+	/**
+	 * Whether each handle is assigned to an existing packet store
+	 */
+	etl::array<bool, ECSSMaxPacketStores> isHandleInUse{};
+
+	static_assert(ECSSMaxPacketStores <= UINT8_MAX + 1, "Every packet store must have its own PacketStoreHandle");
 
 	/**
 	 * Helper function that reads the packet store ID string from a TM[15] message
@@ -50,13 +66,17 @@ private:
 	static inline String<ECSSPacketStoreIdSize> readPacketStoreId(Message& message);
 
 	/**
-	 * Helper function that, given a time-limit, deletes every packet stored in the specified packet-store, up to the
-	 * requested time.
-	 *
-	 * @param packetStoreId required to access the correct packet store.
-	 * @param timeLimit the limit until which, packets are deleted.
+	 * Reads a packet store ID from \p request, and finds the handle of the packet store. If there is no such packet
+	 * store, a NonExistingPacketStore error is reported.
+	 */
+	etl::optional<PacketStoreHandle> readPacketStoreHandle(Message& request);
+
+	/**
+	 * Assigns a free handle to a new packet store, and stores the packet store there. The caller checks that the
+	 * packet store ID is not in use and that the maximum number of packet stores has not been reached. If every
+	 * handle is in use anyway, this reports an internal error and does not add the packet store.
 	 */
-	void deleteContentUntil(const String<ECSSPacketStoreIdSize>& packetStoreId, Time::DefaultCUC timeLimit);
+	void insertPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId, const PacketStore& packetStore);
 
 	/**
 	 * Copies all TM packets from source packet store to the target packet-store, that fall between the two specified
@@ -85,13 +105,13 @@ private:
 	/**
 	 * Checks if the two requested packet stores exist.
 	 *
-	 * @param fromPacketStoreId the source packet store, whose content is to be copied.
-	 * @param toPacketStoreId  the target packet store, which is going to receive the new content.
+	 * @param fromPacketStore the source packet store, whose content is to be copied, if it exists.
+	 * @param toPacketStore  the target packet store, which is going to receive the new content, if it exists.
 	 * @param request used to raise errors.
-	 * @return true if an error has occurred.
+	 * @return true if both packet stores exist.
 	 */
-	bool checkPacketStores(const String<ECSSPacketStoreIdSize>& fromPacketStoreId,
-	                       const String<ECSSPacketStoreIdSize>& toPacketStoreId, const Message& request);
+	bool checkPacketStores(const etl::optional<PacketStoreHandle>& fromPacketStore,
+	                       const etl::optional<PacketStoreHandle>& toPacketStore, const Message& request);
 
 	/**
 	 * Checks whether the time window makes logical sense (end time should be after the start time)
@@ -103,23 +123,23 @@ private:
 	/**
 	 * Checks if the destination packet store is empty, in order to proceed with the copying of packets.
 	 *
-	 * @param toPacketStoreId  the target packet store, which is going to receive the new content. Needed for error
+	 * @param toPacketStore  the target packet store, which is going to receive the new content. Needed for error
 	 * checking.
 	 * @param request used to raise errors.
 	 */
-	bool checkDestinationPacketStore(const String<ECSSPacketStoreIdSize>& toPacketStoreId, const Message& request);
+	bool checkDestinationPacketStore(PacketStoreHandle toPacketStore, const Message& request);
 
 	/**
 	 * Checks if there are no stored Time::DefaultCUC that fall between the two specified time-tags.
 	 *
-	 * @param fromPacketStoreId  the source packet store, whose content is to be copied. Needed for error checking.
+	 * @param fromPacketStore  the source packet store, whose content is to be copied. Needed for error checking.
 	 * @param request used to raise errors.
 	 *
 	 * @note
 	 * This function assumes that `startTime` and `endTime` are valid at this point, so any necessary error checking
 	 * regarding these variables, should have already occurred.
 	 */
-	bool noTimestampInTimeWindow(const String<ECSSPacketStoreIdSize>& fromPacketStoreId, Time::DefaultCUC startTime,
+	bool noTimestampInTimeWindow(PacketStoreHandle fromPacketStore, Time::DefaultCUC startTime,
 	                             Time::DefaultCUC endTime, const Message& request);
 
 	/**
@@ -128,46 +148,43 @@ private:
 	 * @param isAfterTimeTag true indicates that we are examining the case of AfterTimeTag. Otherwise, we are referring
 	 * to the case of BeforeTimeTag.
 	 * @param request used to raise errors.
-	 * @param fromPacketStoreId the source packet store, whose content is to be copied.
+	 * @param fromPacketStore the source packet store, whose content is to be copied.
 	 */
-	bool noTimestampInTimeWindow(const String<ECSSPacketStoreIdSize>& fromPacketStoreId, Time::DefaultCUC timeTag,
+	bool noTimestampInTimeWindow(PacketStoreHandle fromPacketStore, Time::DefaultCUC timeTag,
 	                             const Message& request, bool isAfterTimeTag);
 
 	/**
 	 * Performs all the necessary error checking for the case of FromTagToTag copying of packets.
 	 *
-	 * @param fromPacketStoreId the source packet store, whose content is to be copied.
-	 * @param toPacketStoreId  the target packet store, which is going to receive the new content.
+	 * @param fromPacketStore the source packet store, whose content is to be copied.
+	 * @param toPacketStore  the target packet store, which is going to receive the new content.
 	 * @param request used to raise errors.
 	 * @return true if an error has occurred.
 	 */
-	bool failedFromTagToTag(const String<ECSSPacketStoreIdSize>& fromPacketStoreId,
-	                        const String<ECSSPacketStoreIdSize>& toPacketStoreId, Time::DefaultCUC startTime,
-	                        Time::DefaultCUC endTime, const Message& request);
+	bool failedFromTagToTag(PacketStoreHandle fromPacketStore, PacketStoreHandle toPacketStore,
+	                        Time::DefaultCUC startTime, Time::DefaultCUC endTime, const Message& request);
 
 	/**
 	 * Performs all the necessary error checking for the case of AfterTimeTag copying of packets.
 	 *
-	 * @param fromPacketStoreId the source packet store, whose content is to be copied.
-	 * @param toPacketStoreId  the target packet store, which is going to receive the new content.
+	 * @param fromPacketStore the source packet store, whose content is to be copied.
+	 * @param toPacketStore  the target packet store, which is going to receive the new content.
 	 * @param request used to raise errors.
 	 * @return true if an error has occurred.
 	 */
-	bool failedAfterTimeTag(const String<ECSSPacketStoreIdSize>& fromPacketStoreId,
-	                        const String<ECSSPacketStoreIdSize>& toPacketStoreId, Time::DefaultCUC startTime,
-	                        const Message& request);
+	bool failedAfterTimeTag(PacketStoreHandle fromPacketStore, PacketStoreHandle toPacketStore,
+	                        Time::DefaultCUC startTime, const Message& request);
 
 	/**
 	 * Performs all the necessary error checking for the case of BeforeTimeTag copying of packets.
 	 *
-	 * @param fromPacketStoreId the source packet store, whose content is to be copied.
-	 * @param toPacketStoreId  the target packet store, which is going to receive the new content.
+	 * @param fromPacketStore the source packet store, whose content is to be copied.
+	 * @param toPacketStore  the target packet store, which is going to receive the new content.
 	 * @param request used to raise errors.
 	 * @return true if an error has occurred.
 	 */
-	bool failedBeforeTimeTag(const String<ECSSPacketStoreIdSize>& fromPacketStoreId,
-	                         const String<ECSSPacketStoreIdSize>& toPacketStoreId, Time::DefaultCUC endTime,
-	                         const Message& request);
+	bool failedBeforeTimeTag(PacketStoreHandle fromPacketStore, PacketStoreHandle toPacketStore,
+	                         Time::DefaultCUC endTime, const Message& request);
 
 	/**
 	 * Performs the necessary error checking for a request to start the by-time-range retrieval process.
@@ -175,12 +192,12 @@ private:
 	 * @param request used to raise errors.
 	 * @return true if an error has occurred.
 	 */
-	bool failedStartOfByTimeRangeRetrieval(const String<ECSSPacketStoreIdSize>& packetStoreId, Message& request);
+	bool failedStartOfByTimeRangeRetrieval(const etl::optional<PacketStoreHandle>& packetStore, Message& request);
 
 	/**
 	 * Forms the content summary of the specified packet-store and appends it to a report message.
 	 */
-	void createContentSummary(Message& report, const String<ECSSPacketStoreIdSize>& packetStoreId);
+	void createContentSummary(Message& report, const PacketStore& packetStore);
 
 public:
 	inline static constexpr ServiceTypeNum ServiceType = 15;
@@ -223,6 +240,25 @@ public:
 	 */
 	void addTelemetryToPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId, Time::DefaultCUC timestamp);
 
+	/**
+	 * Adds a serialized TM packet to the specified packet store, with the specified time-tag.
+	 *
+	 * @return false if the packet store is Bounded and has no room left for the packet
+	 */
+	bool addTelemetryToPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId, Time::DefaultCUC timestamp,
+	                               etl::span<const uint8_t> packet);
+
+	/**
+	 * Adds a serialized TM packet to the packet store with the specified handle, with the specified time-tag. This
+	 * avoids looking up the packet store ID for every stored packet.
+	 *
+	 * @return false if the packet store is Bounded and has no room left for the packet
+	 */
+	bool addTelemetryToPacketStore(PacketStoreHandle packetStore, Time::DefaultCUC timestamp,
+	                               etl::span<const uint8_t> packet) {
+		return packetStores[packetStore].storePacket(timestamp, packet);
+	}
+
 	/**
 	 * Deletes the content from all the packet stores.
 	 */
@@ -238,6 +274,19 @@ public:
 	 */
 	PacketStore& getPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId);
 
+	/**
+	 * Returns the packet store with the specified handle.
+	 */
+	PacketStore& getPacketStore(PacketStoreHandle packetStore) {
+		return packetStores[packetStore];
+	}
+
+	/**
+	 * Returns the handle of the packet store with the specified packet store ID, if it exists. The handle stays the
+	 * same until the packet store is deleted, and can be reused by a packet store created afterwards.
+	 */
+	etl::optional<PacketStoreHandle> findPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId) const;
+
 	/**
 	 * Returns true if the specified packet store is present in packet stores.
 	 */
@@ -248,9 +297,67 @@ public:
 	 * packet store. Implemented to reduce duplication. If N = 0, then function is applied to all packet stores.
 	 * Incorrect packet store IDs are ignored and generate an error.
 
-	 * @param function the job to be done after the error checking.
-	 */
-	void executeOnPacketStores(Message& request, const std::function<void(PacketStore&)>& function);
+	 * @param function the job to be done after the error checking, called as `function(PacketStore&)`.
+	 */
+	template <typename Function>
+	void executeOnPacketStores(Message& request, Function&& function) {
+		const NumOfPacketStores numOfPacketStores = request.readUint16();
+		if (numOfPacketStores == 0) {
+			for (const auto& packetStore: packetStoreHandles) {
+				function(packetStores[packetStore.second]);
+			}
+			return;
+		}
+
+		for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
+			auto packetStore = readPacketStoreHandle(request);
+			if (not packetStore) {
+				continue;
+			}
+			function(packetStores[*packetStore]);
+		}
+	}
+
+	/**
+	 * Hands out the next packets of the by-time-range and open retrieval processes in progress, for the packet stores
+	 * that use \p virtualChannel. This is meant to be called periodically by the platform, once for every virtual
+	 * channel, with the number of bytes that the downlink can take until the next call.
+	 *
+	 * The packet stores are served in turns, one packet at a time, so that a large retrieval does not starve the other
+	 * packet stores. Each packet store keeps its own position, so a suspended retrieval resumes where it stopped.
+	 *
+	 * @param byteBudget the max number of bytes to hand out
+	 * @param downlink called as `bool downlink(etl::span<const uint8_t> packet)` for every retrieved packet. The span
+	 * points inside the packet store, and is only valid during the call. Returning false means that the downlink
+	 * cannot take more packets right now, and stops the retrieval without losing the packet.
+	 * @return the number of bytes handed out
+	 */
+	template <typename Downlink>
+	uint32_t retrievePackets(VirtualChannel virtualChannel, uint32_t byteBudget, Downlink&& downlink) {
+		uint32_t retrievedBytes = 0;
+		bool isRetrieving = true;
+
+		while (isRetrieving) {
+			isRetrieving = false;
+			for (const auto& packetStoreHandle: packetStoreHandles) {
+				auto& packetStore = packetStores[packetStoreHandle.second];
+				if (packetStore.virtualChannel != virtualChannel) {
+					continue;
+				}
+				etl::span<const uint8_t> packet;
+				if (not packetStore.nextPacketToRetrieve(packet) or (retrievedBytes + packet.size()) > byteBudget) {
+					continue;
+				}
+				if (not downlink(packet)) {
+					return retrievedBytes;
+				}
+				packetStore.markPacketRetrieved();
+				retrievedBytes += static_cast<uint32_t>(packet.size());
+				isRetrieving = true;
+			}
+		}
+		return retrievedBytes;
+	}
 
 	/**
 	 * TC[15,1] request to enable the packet stores' storage function
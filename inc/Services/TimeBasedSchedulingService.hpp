@@ -3,8 +3,10 @@
 
 #include "CRCHelper.hpp"
 #include "ErrorHandler.hpp"
+#include "IndexedMinHeap.hpp"
 #include "MessageParser.hpp"
 #include "Service.hpp"
+#include "etl/bitset.h"
 #include "etl/list.h"
 
 // Include platform specific files
@@ -14,6 +16,8 @@
 /**
  * @def GROUPS_ENABLED
  * @brief Indicates whether scheduling groups are enabled
+ *
+ * @details When enabled, every TC[11,4] instruction carries a group ID, and TC[11,24] and TC[11,25] are accepted
  */
 #define GROUPS_ENABLED 0 // NOLINT(cppcoreguidelines-macro-usage)
 
@@ -21,7 +25,8 @@
  * @def SUB_SCHEDULES_ENABLED
  * @brief Indicates whether sub-schedules are supported
  *
- * @details Sub-schedules are currently not implemented so this has no effect
+ * @details When enabled, every TC[11,4] instruction carries a sub-schedule ID, and TC[11,20] and TC[11,21] are
+ * accepted
  */
 #define SUB_SCHEDULES_ENABLED 0 // NOLINT(cppcoreguidelines-macro-usage)
 
@@ -70,14 +75,72 @@ private:
 		waiting = 1,
 	};
 
+	/**
+	 * The slot of an activity in the MRAM storage area
+	 */
+	using ActivityId = uint16_t;
+	static_assert(ECSSMaxNumberOfTimeSchedActivities < UINT16_MAX, "The activity slots must fit in an ActivityId");
+
 	typedef struct {
-		uint8_t id = 0;  // Id in the MRAM storage area
+		ActivityId id = 0;  // Id in the MRAM storage area
 		UTCTimestamp timestamp;
 		Activity_State state = Activity_State::invalid;
+		uint8_t subScheduleId = 0;
+		uint8_t groupId = 0;
 	}ActivityEntry;
 
-	static constexpr uint32_t activitiesEntriesArraySize = 9 * ECSSMaxNumberOfTimeSchedActivities;
-	static constexpr uint32_t MRAM_BLOCKS_OFFSET_ACTIVITIES_LIST = 2;
+	static constexpr uint16_t MRAM_BLOCK_DATA_SIZE = MemoryFilesystem::MRAM_DATA_BLOCK_SIZE - 1;
+
+	/**
+	 * @brief Layout of the snapshot of the schedule
+	 *
+	 * @details The first block holds the format version, the generation of the journal, the enabled
+	 * sub-schedules and groups, the CRC of the entries and the CRC of the header itself. It is followed by the
+	 * entries, each one at a fixed position given by its slot, and never crossing a block boundary.
+	 *
+	 * There are two snapshot slots. A new snapshot is always written to the slot that is not in use, entries first
+	 * and header last, so the snapshot in use and its journal stay intact until the new header is complete. On load,
+	 * the slot with the newest generation whose header and entries match their CRCs is used.
+	 */
+	static constexpr uint8_t SCHEDULE_FORMAT_VERSION = 3;
+	static constexpr uint8_t SNAPSHOT_ENTRY_SIZE = 10; // State, release time, sub-schedule ID, group ID
+	static constexpr uint8_t SNAPSHOT_ENTRIES_PER_BLOCK = MRAM_BLOCK_DATA_SIZE / SNAPSHOT_ENTRY_SIZE;
+	static constexpr uint32_t MRAM_BLOCKS_SNAPSHOT = 1 + ((ECSSMaxNumberOfTimeSchedActivities + SNAPSHOT_ENTRIES_PER_BLOCK - 1) / SNAPSHOT_ENTRIES_PER_BLOCK);
+	static constexpr uint8_t SNAPSHOT_SLOTS = 2;
+	static constexpr uint8_t SNAPSHOT_HEADER_SIZE = 3 + ((ECSSMaxNumberOfTimeSchedSubSchedules + 7) / 8) + ((ECSSMaxNumberOfTimeSchedGroups + 7) / 8) + 4;
+	static_assert(SNAPSHOT_HEADER_SIZE <= MRAM_BLOCK_DATA_SIZE, "The snapshot header must fit in a block");
+
+	static constexpr uint32_t MRAM_BLOCKS_OFFSET_ACTIVITIES_LIST = SNAPSHOT_SLOTS * MRAM_BLOCKS_SNAPSHOT;
+
+	/**
+	 * @brief The changes of the schedule that are appended to the journal
+	 *
+	 * @details Every record carries the resulting state of one activity, so that replaying a record more than
+	 * once has no further effect.
+	 */
+	enum class Journal_Record: uint8_t {
+		empty = 0,
+		insert = 1,
+		execute = 2,
+		invalidate = 3,
+	};
+
+	/**
+	 * Type, 2-byte id, release time, sub-schedule ID, group ID, 2-byte generation and 1-byte check of a journal record
+	 */
+	static constexpr uint8_t JOURNAL_RECORD_SIZE = 15;
+	static constexpr uint8_t JOURNAL_RECORDS_PER_BLOCK = MRAM_BLOCK_DATA_SIZE / JOURNAL_RECORD_SIZE;
+
+	/**
+	 * The journal is as large as the snapshot, so that compacting costs at most one block write per record
+	 */
+	static constexpr uint32_t MRAM_BLOCKS_JOURNAL = (MRAM_BLOCKS_SNAPSHOT > 4) ? MRAM_BLOCKS_SNAPSHOT : 4;
+	static constexpr uint32_t JOURNAL_CAPACITY = JOURNAL_RECORDS_PER_BLOCK * MRAM_BLOCKS_JOURNAL;
+
+	/**
+	 * The journal is stored right after the last activity
+	 */
+	static constexpr uint32_t MRAM_BLOCKS_OFFSET_JOURNAL = MRAM_BLOCKS_OFFSET_ACTIVITIES_LIST + (ECSSMaxNumberOfTimeSchedActivities * MRAM_BLOCKS_PER_ACTIVITY);
 
 	/**
 	 * @brief Request identifier of the received packet
@@ -113,48 +176,187 @@ private:
 	};
 
 
-	static bool isEarlier(const UTCTimestamp& a, const UTCTimestamp& b) {
-		if (a.year != b.year) return a.year < b.year;
-		if (a.month != b.month) return a.month < b.month;
-		if (a.day != b.day) return a.day < b.day;
-		if (a.hour != b.hour) return a.hour < b.hour;
-		if (a.minute != b.minute) return a.minute < b.minute;
-		return a.second < b.second;
-	}
+	/**
+	 * @brief RAM copy of the activity entries, indexed by their id in the MRAM storage area
+	 *
+	 * @details It is loaded once from MRAM by \ref loadActivityIndex, and every change is written back with
+	 * \ref appendJournalRecord, so that the polling path never has to read MRAM.
+	 */
+	etl::array<ActivityEntry, ECSSMaxNumberOfTimeSchedActivities> activityEntries{};
+
+	/**
+	 * @brief The ids of the waiting activities, ordered by their release time
+	 *
+	 * @details The next activity to be released is at the top of the heap. This replaces sorting the whole entry
+	 * table on every scheduler tick.
+	 */
+	IndexedMinHeap<UTCTimestamp, ECSSMaxNumberOfTimeSchedActivities> activityIndex;
+
+	/**
+	 * @brief Stack of the slots that are not used by a waiting activity
+	 *
+	 * @details A new activity takes the slot at the top in O(1). That is the slot freed most recently, not necessarily
+	 * the lowest one; the lowest free slot is only at the top right after \ref rebuildActivityIndex.
+	 */
+	etl::array<ActivityId, ECSSMaxNumberOfTimeSchedActivities> freeActivitySlots{};
+
+	ActivityId freeActivitySlotCount = 0;
+
+	/**
+	 * The sub-schedules whose activities are released. All of them are enabled after a reset.
+	 */
+	etl::bitset<ECSSMaxNumberOfTimeSchedSubSchedules> enabledSubSchedules;
+
+	/**
+	 * The groups whose activities are released. All of them are enabled after a reset.
+	 */
+	etl::bitset<ECSSMaxNumberOfTimeSchedGroups> enabledGroups;
+
+	/**
+	 * True when \ref activityEntries and \ref activityIndex mirror the schedule stored in MRAM
+	 */
+	bool activityIndexLoaded = false;
+
+	/**
+	 * The generation of the snapshot in use. Only the journal records of the same generation apply on top of it.
+	 */
+	uint16_t journalGeneration = 0;
+
+	/**
+	 * The newest generation of the two snapshot slots, even if that snapshot could not be used. New snapshots get the
+	 * next generation, so that no journal record that is already stored applies to them.
+	 */
+	uint16_t latestSnapshotGeneration = 0;
+
+	/**
+	 * False when no snapshot header could be read, so the generation of the records in the journal is unknown
+	 */
+	bool isLatestSnapshotGenerationKnown = false;
+
+	/**
+	 * The snapshot slot in use, 0 or 1. The next snapshot is written to the other one.
+	 */
+	uint8_t activeSnapshotSlot = 0;
+
+	/**
+	 * The number of records in the journal since the last snapshot
+	 */
+	uint32_t journalRecordCount = 0;
+
+	/**
+	 * RAM copy of the journal block that records are currently appended to
+	 */
+	etl::array<uint8_t, MemoryFilesystem::MRAM_DATA_BLOCK_SIZE - 1> journalBlock{};
+
+	/**
+	 * @brief Reads the last snapshot from MRAM, replays the journal on top of it, and rebuilds
+	 * \ref activityEntries and \ref activityIndex
+	 *
+	 * @return The error of reading the snapshot, if any
+	 */
+	SpacecraftErrorCode loadActivityIndex();
 
-	static bool isValidScheduled(const ActivityEntry& entry) {
-		return entry.state == Activity_State::waiting;
+	/**
+	 * @brief Reads the newest valid snapshot of the schedule from MRAM into \ref activityEntries
+	 *
+	 * @details If the newest snapshot does not match its CRCs, e.g. because it was being written during a reset, the
+	 * one in the other slot is used.
+	 */
+	SpacecraftErrorCode readScheduleSnapshot();
+
+	/**
+	 * @brief Reads the header block of snapshot slot \p slot into \p header
+	 *
+	 * @return Whether the header is of the current format and matches its CRC
+	 */
+	bool readSnapshotHeader(uint8_t slot, etl::array<uint8_t, MRAM_BLOCK_DATA_SIZE>& header, SpacecraftErrorCode& status);
+
+	/**
+	 * @brief Returns the generation stored in a snapshot \p header
+	 */
+	static uint16_t readSnapshotGeneration(const etl::array<uint8_t, MRAM_BLOCK_DATA_SIZE>& header) {
+		return (static_cast<uint16_t>(header[1]) << 8) | header[2];
 	}
 
 	/**
-	 * @brief Sort the activities by their release time
+	 * @brief Reads the entries of snapshot slot \p slot into \ref activityEntries, and the enabled sub-schedules and
+	 * groups from its \p header
 	 *
-	 * @details The ECSS standard requires that the activities are sorted in the TM message
-	 * response. Also it is better to have the activities sorted.
+	 * @return Whether the entries match the CRC of the header
 	 */
-	static void sortActivityEntries(ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities]) {
-		// Step 1: Partition valid (waiting) vs others
-		int validCount = 0;
+	bool readSnapshotEntries(uint8_t slot, const etl::array<uint8_t, MRAM_BLOCK_DATA_SIZE>& header, SpacecraftErrorCode& status);
 
-		for (int i = 0; i < ECSSMaxNumberOfTimeSchedActivities; ++i) {
-			if (isValidScheduled(entries[i])) {
-				if (i != validCount) {
-					std::swap(entries[i], entries[validCount]);
-				}
-				++validCount;
-			}
-		}
+	/**
+	 * @brief Stores \ref activityEntries as the snapshot of the schedule, with generation \p generation, in the slot
+	 * that is not in use
+	 *
+	 * @details The header block is written last. Until then, the snapshot in use and its journal are untouched, so an
+	 * interrupted write only leaves a slot that is ignored on load.
+	 */
+	SpacecraftErrorCode storeScheduleSnapshot(uint16_t generation);
 
-		// Step 2: Sort only the valid part by timestamp
-		for (int i = 0; i < validCount - 1; ++i) {
-			for (int j = i + 1; j < validCount; ++j) {
-				if (isEarlier(entries[j].timestamp, entries[i].timestamp)) {
-					std::swap(entries[i], entries[j]);
-				}
-			}
-		}
+	/**
+	 * @brief Rebuilds \ref activityIndex and \ref freeActivitySlots from \ref activityEntries
+	 */
+	void rebuildActivityIndex();
+
+	/**
+	 * @return Whether \p entry is waiting, and its sub-schedule and group are enabled
+	 */
+	bool isActivityReleasable(const ActivityEntry& entry) const {
+		return (entry.state == Activity_State::waiting) && enabledSubSchedules.test(entry.subScheduleId) &&
+		       enabledGroups.test(entry.groupId);
 	}
 
+	/**
+	 * @brief Reads the list of IDs of TC[11,20], TC[11,21], TC[11,24] or TC[11,25] and enables or disables them
+	 *
+	 * @details An empty list applies to all IDs. The IDs that do not exist are rejected one by one.
+	 */
+	template <size_t Size>
+	void setEnabledIds(Message& request, etl::bitset<Size>& enabledIds, bool enable);
+
+	/**
+	 * @brief Applies the valid records of the journal, in order, to \ref activityEntries
+	 *
+	 * @details Replay stops at the first empty, corrupted or older generation record, which is where the next
+	 * record will be appended.
+	 */
+	void replayActivityJournal();
+
+	/**
+	 * @brief Appends a record with the current state of the activity with id \p id to the journal
+	 *
+	 * @details Only the journal block that holds the record is written, up to the end of the record. Once the record is
+	 * stored, the journal is compacted into a new snapshot if it is full, so there is always room for the next record.
+	 * If the record cannot be written, the change is stored in a new snapshot instead.
+	 */
+	SpacecraftErrorCode appendJournalRecord(Journal_Record type, ActivityId id);
+
+	/**
+	 * @brief Stores \ref activityEntries as a new snapshot, which invalidates all the journal records
+	 *
+	 * @details The new snapshot replaces the snapshot in use and its journal at once, when its header is written.
+	 */
+	SpacecraftErrorCode compactActivityJournal();
+
+	/**
+	 * @brief Invalidates all activities, erases the journal and stores an empty snapshot
+	 */
+	SpacecraftErrorCode resetActivityEntries();
+
+	/**
+	 * @brief Marks the activity with id \p id as waiting to be released at \p releaseTime
+	 *
+	 * @details The slot must already be taken out of \ref freeActivitySlots
+	 */
+	void scheduleActivityEntry(ActivityId id, const UTCTimestamp& releaseTime);
+
+	/**
+	 * @brief Marks the activity with id \p id as invalid, removes it from \ref activityIndex and frees its slot
+	 */
+	void invalidateActivityEntry(ActivityId id);
+
 	/**
 	 * @brief Define a friend in order to be able to access private members during testing
 	 *
@@ -185,6 +387,10 @@ public:
 		TimeBasedScheduledSummaryReport = 13,
 		TimeShiftALlScheduledActivities = 15,
 		DetailReportAllScheduledActivities = 16,
+		EnableTimeBasedSubSchedules = 20,
+		DisableTimeBasedSubSchedules = 21,
+		EnableTimeBasedSchedulingGroups = 24,
+		DisableTimeBasedSchedulingGroups = 25,
 	};
 
 	/**
@@ -268,6 +474,37 @@ public:
 	 */
 	void detailReportAllActivities(const Message& request);
 
+	/**
+	 * @brief TC[11,20] enable time-based sub-schedules
+	 *
+	 * @details The waiting activities of the enabled sub-schedules are released again
+	 * @param request Provide the received message as a parameter
+	 */
+	void enableSubSchedules(Message& request);
+
+	/**
+	 * @brief TC[11,21] disable time-based sub-schedules
+	 *
+	 * @details The activities of the disabled sub-schedules stay in the schedule, but are not released
+	 * @param request Provide the received message as a parameter
+	 */
+	void disableSubSchedules(Message& request);
+
+	/**
+	 * @brief TC[11,24] enable time-based scheduling groups
+	 *
+	 * @param request Provide the received message as a parameter
+	 */
+	void enableGroups(Message& request);
+
+	/**
+	 * @brief TC[11,25] disable time-based scheduling groups
+	 *
+	 * @details The activities of the disabled groups stay in the schedule, but are not released
+	 * @param request Provide the received message as a parameter
+	 */
+	void disableGroups(Message& request);
+
 	/**
 	 * @brief TM[11,10] time-based schedule detail report
 	 *
@@ -295,17 +532,13 @@ public:
 	 */
 	void execute(Message& message);
 
-	static SpacecraftErrorCode readActivityEntries(ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities]);
-
-	static SpacecraftErrorCode storeActivityEntries(ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities]);
-
-	static SpacecraftErrorCode storeScheduledActivity(ScheduledActivity activity, const uint8_t id);
+	static SpacecraftErrorCode storeScheduledActivity(ScheduledActivity activity, const ActivityId id);
 
-	static SpacecraftErrorCode recoverScheduledActivity(ScheduledActivity& activity, const uint8_t id);
+	static SpacecraftErrorCode recoverScheduledActivity(ScheduledActivity& activity, const ActivityId id);
 
 	void initEsotericVariables();
 
-	void checkForPeriodicScheduledActivity(const uint8_t id);
+	void checkForPeriodicScheduledActivity(const ActivityId id);
 
 	bool isExecutionTimeWithinMargin(UTCTimestamp currentTime, UTCTimestamp executionTime) const;
 
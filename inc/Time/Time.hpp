@@ -264,6 +264,60 @@ namespace Time {
 		return (year % 400) == 0; //NOLINT(cppcoreguidelines-avoid-magic-numbers)
 	}
 
+	/**
+	 * A date of the Gregorian calendar
+	 */
+	struct CivilDate {
+		uint16_t year;
+		uint8_t month;
+		uint8_t day;
+	};
+
+	/**
+	 * Returns the number of days from the Unix epoch (1 January 1970) to a date of the Gregorian calendar.
+	 *
+	 * This is a closed-form calculation that takes a constant number of integer operations, instead of iterating over
+	 * every year and month since the epoch.
+	 *
+	 * @see http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+	 */
+	constexpr int32_t daysFromCivil(uint16_t year, uint8_t month, uint8_t day) {
+		// Years start on 1 March, so that the leap day is the last day of the year
+		const int32_t marchYear = static_cast<int32_t>(year) - ((month <= 2U) ? 1 : 0);
+		const int32_t era = ((marchYear >= 0) ? marchYear : (marchYear - 399)) / 400; //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const auto yearOfEra = static_cast<uint32_t>(marchYear - (era * 400)); //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const uint32_t marchMonth = (month > 2U) ? (month - 3U) : (month + 9U); //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const uint32_t dayOfYear = (((153U * marchMonth) + 2U) / 5U) + day - 1U; //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const uint32_t dayOfEra = (yearOfEra * 365U) + (yearOfEra / 4U) - (yearOfEra / 100U) + dayOfYear; //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+
+		return (era * 146097) + static_cast<int32_t>(dayOfEra) - 719468; //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	}
+
+	/**
+	 * Returns the date of the Gregorian calendar that is a number of days after the Unix epoch (1 January 1970).
+	 * This is the inverse of @ref daysFromCivil.
+	 *
+	 * @see http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+	 */
+	constexpr CivilDate civilFromDays(int32_t days) {
+		days += 719468; //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const int32_t era = ((days >= 0) ? days : (days - 146096)) / 146097; //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const auto dayOfEra = static_cast<uint32_t>(days - (era * 146097)); //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const uint32_t yearOfEra = (dayOfEra - (dayOfEra / 1460U) + (dayOfEra / 36524U) - (dayOfEra / 146096U)) / 365U; //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const uint32_t dayOfYear = dayOfEra - ((365U * yearOfEra) + (yearOfEra / 4U) - (yearOfEra / 100U)); //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const uint32_t marchMonth = ((5U * dayOfYear) + 2U) / 153U; //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const uint32_t day = dayOfYear - (((153U * marchMonth) + 2U) / 5U) + 1U; //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const uint32_t month = (marchMonth < 10U) ? (marchMonth + 3U) : (marchMonth - 9U); //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+		const int32_t year = static_cast<int32_t>(yearOfEra) + (era * 400) + ((month <= 2U) ? 1 : 0); //NOLINT(cppcoreguidelines-avoid-magic-numbers)
+
+		return {static_cast<uint16_t>(year), static_cast<uint8_t>(month), static_cast<uint8_t>(day)};
+	}
+
+	static_assert(daysFromCivil(1970, 1, 1) == 0);
+	static_assert((static_cast<uint64_t>(daysFromCivil(Epoch.year, Epoch.month, Epoch.day)) * SecondsPerDay) == EpochSecondsFromUnix,
+	              "EpochSecondsFromUnix must match the system epoch");
+	static_assert(civilFromDays(daysFromCivil(2024, 2, 29)).day == 29);
+
 	/**
  	* A time shift for scheduled activities measured in seconds
  	*/
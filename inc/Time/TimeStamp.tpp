@@ -71,17 +71,13 @@ TimeStamp<BaseBytes, FractionBytes, Num, Denom>::TimeStamp(const UTCTimestamp& t
 		}
 	};
 
-	for (int year = Time::Epoch.year; year < timestamp.year; ++year) {
-		secondsAdd((Time::isLeapYear(year) ? 366 : 365) * Time::SecondsPerDay);
-	}
-	for (int month = Time::Epoch.month; month < timestamp.month; ++month) {
-		secondsAdd(Time::DaysOfMonth[month - 1] * Time::SecondsPerDay);
-		if ((month == 2U) && Time::isLeapYear(timestamp.year)) {
-			secondsAdd(Time::SecondsPerDay);
-		}
+	const int32_t days = Time::daysFromCivil(timestamp.year, timestamp.month, timestamp.day) -
+	                     Time::daysFromCivil(Time::Epoch.year, Time::Epoch.month, Time::Epoch.day);
+	if (days < 0) {
+		ErrorHandler::reportInternalError(ErrorHandler::TimeStampOutOfBounds);
+	} else {
+		secondsAdd(static_cast<TAICounter_t>(days) * Time::SecondsPerDay);
 	}
-
-	secondsAdd((timestamp.day - Time::Epoch.day) * Time::SecondsPerDay);
 	secondsAdd(timestamp.hour * Time::SecondsPerHour);
 	secondsAdd(timestamp.minute * Time::SecondsPerMinute);
 	secondsAdd(timestamp.second);
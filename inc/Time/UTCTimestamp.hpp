@@ -49,6 +49,13 @@ public:
 	 */
 	[[nodiscard]] uint64_t toEpochSeconds() const;
 
+	/**
+	 * Converts seconds since Unix epoch to a UTCTimestamp
+	 *
+	 * @param epochSeconds Number of seconds since Unix epoch (January 1, 1970)
+	 */
+	static UTCTimestamp fromEpochSeconds(uint64_t epochSeconds);
+
 	/**
 	 * Add a duration to the timestamp
 	 *
@@ -59,44 +66,13 @@ public:
 	template <class Duration, typename = std::enable_if_t<Time::is_duration_v<Duration>>>
 	void operator+=(const Duration& in) {
 		using namespace std::chrono;
-		using namespace Time;
 
 		if (in < Duration::zero()) {
 			ErrorHandler::reportInternalError(ErrorHandler::InvalidTimeStampInput);
 			return;
 		}
 
-		uint64_t seconds = duration_cast<duration<uint64_t>>(in).count();
-
-		while (seconds >= (isLeapYear(year) ? 366L : 365L) * SecondsPerDay) { // NOLINT(cppcoreguidelines-avoid-magic-numbers)
-			seconds -= (isLeapYear(year) ? 366L : 365L) * SecondsPerDay;      // NOLINT(cppcoreguidelines-avoid-magic-numbers)
-			year++;
-		}
-
-		while (seconds >= (daysOfMonth() * uint64_t{SecondsPerDay})) {
-			seconds -= daysOfMonth() * uint64_t{SecondsPerDay};
-			month++;
-
-			if (month > MonthsPerYear) {
-				// Month overflow needs to be taken care here, so that daysOfMonth() knows
-				// what month it is.
-				month -= MonthsPerYear;
-				year++;
-			}
-		}
-
-		day += seconds / SecondsPerDay;
-		seconds -= (seconds / SecondsPerDay) * SecondsPerDay;
-
-		hour += seconds / SecondsPerHour;
-		seconds -= (seconds / SecondsPerHour) * SecondsPerHour;
-
-		minute += seconds / SecondsPerMinute;
-		seconds -= (seconds / SecondsPerMinute) * SecondsPerMinute;
-
-		second += seconds;
-
-		repair();
+		*this = fromEpochSeconds(toEpochSeconds() + duration_cast<duration<uint64_t>>(in).count());
 	}
 
 	/**
@@ -166,30 +142,15 @@ private:
 	 * The year of the Unix epoch
 	 */
 	inline static const uint16_t UNIXEpochYear = 1970;
-	/**
-	 * Makes sure that all time fields are within their bounds
-	 *
-	 * For example, if `hours == 1, minutes == 63`, then this function will carry over the numbers so that
-	 * `hours == 2, minutes == 3`.
-	 *
-	 * @note This performs max one propagation for every field.
-	 * For example, if `hours == 1, minutes == 123`, then only the first 60 minutes will be carried over.
-	 */
-	void repair();
 
 	/**
-	 * Find the number of days within the current @ref month.
-	 * Includes leap year calculation.
+	 * The fields of the timestamp packed in decreasing significance, so that two timestamps compare in the same way
+	 * as their keys
 	 */
-	uint8_t daysOfMonth() const {
-		using namespace Time;
-
-		uint8_t daysOfMonth = DaysOfMonth[month - 1];
-		if (month == 2 && isLeapYear(year)) {
-			daysOfMonth++;
-		}
-
-		return daysOfMonth;
+	uint64_t comparisonKey() const {
+		return (static_cast<uint64_t>(year) << 40U) | (static_cast<uint64_t>(month) << 32U) |
+		       (static_cast<uint64_t>(day) << 24U) | (static_cast<uint64_t>(hour) << 16U) |
+		       (static_cast<uint64_t>(minute) << 8U) | static_cast<uint64_t>(second);
 	}
 };
 
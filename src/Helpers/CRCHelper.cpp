@@ -1,9 +1,62 @@
 #include "CRCHelper.hpp"
+#include <etl/array.h>
 #include "TypeDefinitions.hpp"
 
-uint16_t CRCHelper::calculateCRC(const uint8_t* message, uint32_t length) {
-	// shift register contains all 1's initially (ECSS-E-ST-70-41C, Annex B - CRC and ISO checksum)
-	CRCSize shiftReg = InitialShiftRegisterValue;
+namespace {
+	/**
+	 * The maximum number of bytes consumed per iteration by the sliced backends
+	 */
+	constexpr uint8_t MaxSlices = 8U;
+
+	/**
+	 * Number of possible values of a byte, i.e. number of entries in each lookup table
+	 */
+	constexpr uint16_t TableSize = 256U;
+
+	using CRCTable = etl::array<CRCSize, TableSize>;
+	using CRCSliceTables = etl::array<CRCTable, MaxSlices>;
+
+	/**
+	 * Generates the lookup tables of the table-driven and sliced backends.
+	 *
+	 * Entry `tables[0][b]` is the shift register contents after feeding byte `b` into an all-zero register, i.e. the
+	 * classic byte-wise CRC table. Entry `tables[k][b]` is the same value after feeding `k` more zero bytes, which lets
+	 * the sliced backends process the bytes of a word independently of each other.
+	 */
+	constexpr CRCSliceTables generateTables() {
+		CRCSliceTables tables{};
+
+		for (uint16_t byte = 0; byte < TableSize; byte++) {
+			auto shiftReg = static_cast<CRCSize>(byte << 8U);
+			for (uint8_t bit = 0; bit < 8U; bit++) {
+				if ((shiftReg & 0x8000U) != 0U) {
+					shiftReg = static_cast<CRCSize>((shiftReg << 1U) ^ 0x1021U);
+				} else {
+					shiftReg = static_cast<CRCSize>(shiftReg << 1U);
+				}
+			}
+			tables[0][byte] = shiftReg;
+		}
+
+		for (uint8_t slice = 1; slice < MaxSlices; slice++) {
+			for (uint16_t byte = 0; byte < TableSize; byte++) {
+				const CRCSize previous = tables[slice - 1][byte];
+				tables[slice][byte] = static_cast<CRCSize>((previous << 8U) ^ tables[0][previous >> 8U]);
+			}
+		}
+
+		return tables;
+	}
+
+	constexpr CRCSliceTables Tables = generateTables();
+
+	// Sanity check of the generated tables against the known CRC16/CCITT values
+	static_assert(Tables[0][1] == 0x1021U);
+	static_assert(Tables[1][1] == 0x3331U);
+} // namespace
+
+uint16_t CRCHelper::updateBitwise(uint16_t crc, const uint8_t* message, uint32_t length) {
+	CRCSize shiftReg = crc;
 
 	for (uint32_t i = 0; i < length; i++) {
 		// "copy" (XOR w/ existing contents) the current msg bits into the MSB of the shift register
@@ -23,7 +76,67 @@ uint16_t CRCHelper::calculateCRC(const uint8_t* message, uint32_t length) {
 	return shiftReg;
 }
 
+uint16_t CRCHelper::updateTable(uint16_t crc, const uint8_t* message, uint32_t length) {
+	CRCSize shiftReg = crc;
+
+	for (uint32_t i = 0; i < length; i++) {
+		shiftReg = static_cast<CRCSize>((shiftReg << BitNumber) ^ Tables[0][(shiftReg >> BitNumber) ^ message[i]]);
+	}
+	return shiftReg;
+}
+
+template <uint8_t Slices>
+uint16_t CRCHelper::updateSliced(uint16_t crc, const uint8_t* message, uint32_t length) {
+	static_assert(Slices >= 2U && Slices <= MaxSlices, "The sliced backend needs between 2 and 8 tables");
+	CRCSize shiftReg = crc;
+
+	while (length >= Slices) {
+		// The 16-bit register only overlaps with the first two bytes of the slice
+		CRCSize next = Tables[Slices - 1][(shiftReg >> BitNumber) ^ message[0]] ^
+		               Tables[Slices - 2][(shiftReg & 0xFFU) ^ message[1]];
+		for (uint8_t i = 2; i < Slices; i++) {
+			next ^= Tables[Slices - 1 - i][message[i]];
+		}
+		shiftReg = next;
+		message += Slices;
+		length -= Slices;
+	}
+	return updateTable(shiftReg, message, length);
+}
+
+uint16_t CRCHelper::update(Backend backend, uint16_t crc, const uint8_t* message, uint32_t length) {
+	switch (backend) {
+		case Backend::Bitwise:
+			return updateBitwise(crc, message, length);
+		case Backend::Table:
+			return updateTable(crc, message, length);
+		case Backend::SliceBy4:
+			return updateSliced<4>(crc, message, length);
+		case Backend::SliceBy8:
+			return updateSliced<8>(crc, message, length);
+		default:
+			return updateBitwise(crc, message, length);
+	}
+}
+
+uint16_t CRCHelper::calculateCRC(const uint8_t* message, uint32_t length) {
+	// shift register contains all 1's initially (ECSS-E-ST-70-41C, Annex B - CRC and ISO checksum)
+	return update(SelectedBackend, InitialShiftRegisterValue, message, length);
+}
+
+uint16_t CRCHelper::calculateCRC(Backend backend, const uint8_t* message, uint32_t length) {
+	return update(backend, InitialShiftRegisterValue, message, length);
+}
+
 uint16_t CRCHelper::validateCRC(const uint8_t* message, uint32_t length) {
 	return calculateCRC(message, length);
 	// CRC result of a correct msg w/checksum appended is 0
 }
+
+void CRCHelper::Context::update(const uint8_t* data, uint32_t length) {
+	shiftRegister = CRCHelper::update(SelectedBackend, shiftRegister, data, length);
+}
+
+void CRCHelper::Context::update(uint8_t byte) {
+	shiftRegister = static_cast<CRCSize>((shiftRegister << BitNumber) ^ Tables[0][(shiftRegister >> BitNumber) ^ byte]);
+}
@@ -0,0 +1,515 @@
+#include "FilePacketStoreBackend.hpp"
+#include "CRCHelper.hpp"
+#include "ErrorHandler.hpp"
+
+namespace {
+	constexpr uint16_t SegmentMagic = 0x5053U;
+
+	/**
+	 * Positions of the fields of a segment header
+	 */
+	constexpr uint16_t BaseHeaderOffset = 0;        // magic, sequence, CRC
+	constexpr uint16_t BaseHeaderSize = 8;          //
+	constexpr uint16_t RemovedRecordsOffset = 8;    // number of removed records, CRC
+	constexpr uint16_t RemovedRecordsSize = 4;      //
+	constexpr uint16_t SummaryOffset = 12;          // number of records, used bytes, first and last time-tags, CRC
+	constexpr uint16_t SummarySize = 14;            //
+	constexpr uint16_t RecordChecksumOffset = 6;    // after the size and the time-tag of a record
+
+	void writeUint16(uint8_t* data, uint16_t value) {
+		data[0] = static_cast<uint8_t>(value >> 8U);
+		data[1] = static_cast<uint8_t>(value & 0xFFU);
+	}
+
+	void writeUint32(uint8_t* data, uint32_t value) {
+		writeUint16(data, static_cast<uint16_t>(value >> 16U));
+		writeUint16(data + 2, static_cast<uint16_t>(value & 0xFFFFU));
+	}
+
+	uint16_t readUint16(const uint8_t* data) {
+		return static_cast<uint16_t>((data[0] << 8U) | data[1]);
+	}
+
+	uint32_t readUint32(const uint8_t* data) {
+		return (static_cast<uint32_t>(readUint16(data)) << 16U) | readUint16(data + 2);
+	}
+
+	/**
+	 * The CRC of a field of a segment, which also covers the sequence number of the segment
+	 */
+	uint16_t checksum(uint32_t sequence, const uint8_t* data, uint32_t length) {
+		etl::array<uint8_t, 4> sequenceBytes{};
+		writeUint32(sequenceBytes.data(), sequence);
+
+		CRCHelper::Context crc;
+		crc.update(sequenceBytes.data(), sequenceBytes.size());
+		crc.update(data, length);
+		return crc.finalize();
+	}
+
+	/**
+	 * The CRC of a record, which covers the size and time-tag fields in \p header, and the packet
+	 */
+	uint16_t recordChecksum(uint32_t sequence, const uint8_t* header, etl::span<const uint8_t> packet) {
+		etl::array<uint8_t, 4> sequenceBytes{};
+		writeUint32(sequenceBytes.data(), sequence);
+
+		CRCHelper::Context crc;
+		crc.update(sequenceBytes.data(), sequenceBytes.size());
+		crc.update(header, RecordChecksumOffset);
+		crc.update(packet.data(), packet.size());
+		return crc.finalize();
+	}
+
+	Time::DefaultCUC timeTagFromValue(uint32_t value) {
+		const std::chrono::duration<uint32_t, Time::DefaultCUC::Ratio> duration(value);
+		return Time::DefaultCUC(duration);
+	}
+} // namespace
+
+static_assert(SummaryOffset + SummarySize <= FilePacketStoreBackend::HeaderSize, "The segment header must fit its fields");
+
+FilePacketStoreBackend::FilePacketStoreBackend(const Filesystem::Path& path, uint16_t numberOfSegments)
+    : path(path), numberOfSegments(etl::max<uint16_t>(1, etl::min(numberOfSegments, ECSSMaxPacketStoreSegments))) {}
+
+void FilePacketStoreBackend::load() const {
+	if (isLoaded) {
+		return;
+	}
+	isLoaded = true;
+
+	// Find the segments in use from their base headers
+	uint16_t newestSegment = NoSegment;
+	for (uint16_t segment = 0; segment < numberOfSegments; segment++) {
+		segments[segment] = Segment{};
+
+		etl::array<uint8_t, BaseHeaderSize> header{};
+		if (Filesystem::readFile(path, segmentOffset(segment) + BaseHeaderOffset, header)) {
+			continue;
+		}
+		const uint32_t sequence = readUint32(&header[2]);
+		if ((readUint16(&header[0]) != SegmentMagic) or (sequence == 0) or
+		    (readUint16(&header[6]) != checksum(sequence, header.data(), 6))) {
+			continue;
+		}
+		segments[segment].sequence = sequence;
+		if ((newestSegment == NoSegment) or (sequence > segments[newestSegment].sequence)) {
+			newestSegment = segment;
+		}
+	}
+
+	headSegment = 0;
+	usedSegments = 0;
+	isTailSealed = false;
+	storedPackets = 0;
+	storedBytes = 0;
+	appendedBytes = 0;
+	cachedSegment = NoSegment;
+	if (newestSegment == NoSegment) {
+		return;
+	}
+
+	// The segments in use precede the newest one, with consecutive sequence numbers
+	const uint32_t newestSequence = segments[newestSegment].sequence;
+	usedSegments = 1;
+	while ((usedSegments < numberOfSegments) and (newestSequence > usedSegments) and
+	       (segments[(newestSegment + numberOfSegments - usedSegments) % numberOfSegments].sequence ==
+	        newestSequence - usedSegments)) {
+		usedSegments++;
+	}
+	headSegment = (newestSegment + numberOfSegments - usedSegments + 1) % numberOfSegments;
+	nextSequence = newestSequence + 1;
+
+	for (uint16_t i = 0; i < usedSegments; i++) {
+		const uint16_t segment = (headSegment + i) % numberOfSegments;
+		Segment& state = segments[segment];
+
+		etl::array<uint8_t, SummarySize> summary{};
+		const bool hasSummary = not Filesystem::readFile(path, segmentOffset(segment) + SummaryOffset, summary) and
+		                        (readUint16(&summary[12]) == checksum(state.sequence, summary.data(), 12));
+		if (hasSummary) {
+			state.recordCount = readUint16(&summary[0]);
+			state.usedBytes = readUint16(&summary[2]);
+			state.firstTimeTag = timeTagFromValue(readUint32(&summary[4]));
+			state.lastTimeTag = timeTagFromValue(readUint32(&summary[8]));
+		} else {
+			state.recordCount = cacheRecordOffsets(segment, true);
+			state.usedBytes = recordOffsets[state.recordCount];
+			if (state.recordCount > 0) {
+				state.firstTimeTag = timeTagFromValue(recordTimeTags[0]);
+				state.lastTimeTag = timeTagFromValue(recordTimeTags[state.recordCount - 1]);
+			}
+		}
+		isTailSealed = hasSummary;
+
+		state.cumulativeStart = appendedBytes;
+		const uint32_t packetBytes = state.usedBytes - HeaderSize - state.recordCount * RecordHeaderSize;
+		appendedBytes += packetBytes;
+		storedBytes += packetBytes;
+		storedPackets += state.recordCount;
+	}
+
+	// Only the oldest segment may have removed records
+	Segment& head = segments[headSegment];
+	etl::array<uint8_t, RemovedRecordsSize> removedRecords{};
+	if (not Filesystem::readFile(path, segmentOffset(headSegment) + RemovedRecordsOffset, removedRecords) and
+	    (readUint16(&removedRecords[2]) == checksum(head.sequence, removedRecords.data(), 2))) {
+		head.removedRecords = etl::min(readUint16(&removedRecords[0]), head.recordCount);
+	}
+	if (head.removedRecords > 0) {
+		cacheRecordOffsets(headSegment, false);
+		storedBytes -= recordOffsets[head.removedRecords] - HeaderSize - head.removedRecords * RecordHeaderSize;
+		storedPackets -= head.removedRecords;
+	}
+
+	// The oldest segment may have been emptied right before a reset, without being released
+	if ((head.removedRecords == head.recordCount) and not releaseHeadSegment()) {
+		ErrorHandler::reportInternalError(ErrorHandler::PacketStoreWriteError);
+	}
+}
+
+bool FilePacketStoreBackend::writeWithRetries(uint32_t offset, etl::span<const uint8_t> data) const {
+	for (uint8_t attempt = 0; attempt < MaxWriteAttempts; attempt++) {
+		if (not Filesystem::writeFile(path, offset, data)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+uint16_t FilePacketStoreBackend::cacheRecordOffsets(uint16_t segment, bool isRecovering) const {
+	if (not isRecovering and (cachedSegment == segment) and (cachedSequence == segments[segment].sequence)) {
+		return segments[segment].recordCount;
+	}
+	cachedSegment = NoSegment;
+
+	const uint32_t sequence = segments[segment].sequence;
+	const uint16_t recordCount = isRecovering ? MaxRecordsPerSegment : segments[segment].recordCount;
+	const uint16_t usedBytes = isRecovering ? SegmentSize : segments[segment].usedBytes;
+	uint16_t offset = HeaderSize;
+	uint16_t record = 0;
+
+	// The bytes of the segment in [chunkStart, chunkEnd) are in recordBuffer
+	uint16_t chunkStart = 0;
+	uint16_t chunkEnd = 0;
+
+	for (; record < recordCount; record++) {
+		if ((offset + RecordHeaderSize) > usedBytes) {
+			break;
+		}
+		if ((offset + RecordHeaderSize) > chunkEnd) {
+			// When recovering, the end of the written bytes is unknown, so only the header is read
+			chunkStart = offset;
+			chunkEnd = isRecovering ? (offset + RecordHeaderSize) : etl::min<uint16_t>(usedBytes, offset + recordBuffer.size());
+			const etl::span<uint8_t> chunk(recordBuffer.data(), chunkEnd - chunkStart);
+			if (Filesystem::readFile(path, segmentOffset(segment) + chunkStart, chunk)) {
+				break;
+			}
+		}
+		const uint8_t* header = &recordBuffer[offset - chunkStart];
+		const uint16_t packetSize = readUint16(&header[0]);
+		if ((packetSize > maxPacketSize()) or ((offset + RecordHeaderSize + packetSize) > usedBytes)) {
+			break;
+		}
+		const uint32_t recordTimeTag = readUint32(&header[2]);
+
+		if (isRecovering) {
+			// The header is alone at the start of recordBuffer, so the packet is read right after it
+			etl::span<uint8_t> packet(recordBuffer.data() + RecordHeaderSize, packetSize);
+			if (Filesystem::readFile(path, segmentOffset(segment) + offset + RecordHeaderSize, packet) or
+			    (recordChecksum(sequence, header, packet) != readUint16(&header[RecordChecksumOffset]))) {
+				break;
+			}
+		}
+
+		recordOffsets[record] = offset;
+		recordTimeTags[record] = recordTimeTag;
+		offset += RecordHeaderSize + packetSize;
+	}
+	recordOffsets[record] = offset;
+
+	if (isRecovering or (record == recordCount)) {
+		cachedSegment = segment;
+		cachedSequence = sequence;
+	}
+	return record;
+}
+
+FilePacketStoreBackend::RecordLocation FilePacketStoreBackend::locate(size_t position) const {
+	size_t record = position + segments[headSegment].removedRecords;
+	for (uint16_t i = 0; i < usedSegments; i++) {
+		const uint16_t segment = (headSegment + i) % numberOfSegments;
+		if (record < segments[segment].recordCount) {
+			return {segment, static_cast<uint16_t>(record)};
+		}
+		record -= segments[segment].recordCount;
+	}
+	return {tailSegment(), segments[tailSegment()].recordCount};
+}
+
+bool FilePacketStoreBackend::openSegment() {
+	if (usedSegments == numberOfSegments) {
+		return false;
+	}
+	const uint16_t segment = (usedSegments == 0) ? headSegment : static_cast<uint16_t>((tailSegment() + 1) % numberOfSegments);
+	const uint32_t sequence = nextSequence;
+
+	// The removed records and the summary are left invalid, as their CRC does not match the new sequence number
+	etl::array<uint8_t, HeaderSize> header{};
+	writeUint16(&header[BaseHeaderOffset], SegmentMagic);
+	writeUint32(&header[BaseHeaderOffset + 2], sequence);
+	writeUint16(&header[BaseHeaderOffset + 6], checksum(sequence, &header[BaseHeaderOffset], 6));
+	if (not writeWithRetries(segmentOffset(segment), header)) {
+		return false;
+	}
+
+	segments[segment] = Segment{};
+	segments[segment].sequence = sequence;
+	segments[segment].cumulativeStart = appendedBytes;
+	nextSequence++;
+	usedSegments++;
+	isTailSealed = false;
+	return true;
+}
+
+bool FilePacketStoreBackend::sealTailSegment() {
+	const Segment& tail = segments[tailSegment()];
+
+	etl::array<uint8_t, SummarySize> summary{};
+	writeUint16(&summary[0], tail.recordCount);
+	writeUint16(&summary[2], tail.usedBytes);
+	writeUint32(&summary[4], tail.firstTimeTag.formatAsBytes());
+	writeUint32(&summary[8], tail.lastTimeTag.formatAsBytes());
+	writeUint16(&summary[12], checksum(tail.sequence, summary.data(), 12));
+	if (not writeWithRetries(segmentOffset(tailSegment()) + SummaryOffset, summary)) {
+		return false;
+	}
+	isTailSealed = true;
+	return true;
+}
+
+bool FilePacketStoreBackend::writeRemovedRecords() const {
+	const Segment& head = segments[headSegment];
+
+	etl::array<uint8_t, RemovedRecordsSize> removedRecords{};
+	writeUint16(&removedRecords[0], head.removedRecords);
+	writeUint16(&removedRecords[2], checksum(head.sequence, removedRecords.data(), 2));
+	return writeWithRetries(segmentOffset(headSegment) + RemovedRecordsOffset, removedRecords);
+}
+
+bool FilePacketStoreBackend::releaseHeadSegment() const {
+	const etl::array<uint8_t, BaseHeaderSize> header{};
+	const bool isWritten = writeWithRetries(segmentOffset(headSegment) + BaseHeaderOffset, header);
+
+	if (cachedSegment == headSegment) {
+		cachedSegment = NoSegment;
+	}
+	segments[headSegment] = Segment{};
+	headSegment = (headSegment + 1) % numberOfSegments;
+	usedSegments--;
+	if (usedSegments == 0) {
+		isTailSealed = false;
+	}
+	return isWritten;
+}
+
+PacketStoreBackend::AppendResult FilePacketStoreBackend::append(Time::DefaultCUC timeTag, etl::span<const uint8_t> packet) {
+	load();
+	if (packet.size() > maxPacketSize()) {
+		return AppendResult::NoRoom;
+	}
+	const auto packetSize = static_cast<uint16_t>(packet.size());
+	const uint16_t recordSize = RecordHeaderSize + packetSize;
+
+	const bool fitsInTail = (usedSegments > 0) and not isTailSealed and
+	                        ((segments[tailSegment()].usedBytes + recordSize) <= SegmentSize) and
+	                        (segments[tailSegment()].recordCount < MaxRecordsPerSegment);
+	if (not fitsInTail) {
+		if ((usedSegments > 0) and not isTailSealed and not sealTailSegment()) {
+			return AppendResult::WriteError;
+		}
+		if (usedSegments == numberOfSegments) {
+			return AppendResult::NoRoom;
+		}
+		if (not openSegment()) {
+			return AppendResult::WriteError;
+		}
+	}
+	const uint16_t segment = tailSegment();
+	Segment& tail = segments[segment];
+
+	writeUint16(&recordBuffer[0], packetSize);
+	writeUint32(&recordBuffer[2], timeTag.formatAsBytes());
+	etl::copy_n(packet.begin(), packetSize, recordBuffer.begin() + RecordHeaderSize);
+
+	writeUint16(&recordBuffer[RecordChecksumOffset], recordChecksum(tail.sequence, recordBuffer.data(), packet));
+
+	if (not writeWithRetries(segmentOffset(segment) + tail.usedBytes, {recordBuffer.data(), recordSize})) {
+		return AppendResult::WriteError;
+	}
+
+	if ((cachedSegment == segment) and (cachedSequence == tail.sequence)) {
+		recordOffsets[tail.recordCount + 1] = tail.usedBytes + recordSize;
+		recordTimeTags[tail.recordCount] = timeTag.formatAsBytes();
+	}
+	if (tail.recordCount == 0) {
+		tail.firstTimeTag = timeTag;
+	}
+	tail.lastTimeTag = timeTag;
+	tail.recordCount++;
+	tail.usedBytes += recordSize;
+	storedPackets++;
+	storedBytes += packetSize;
+	appendedBytes += packetSize;
+	return AppendResult::Stored;
+}
+
+bool FilePacketStoreBackend::removeOldest() {
+	load();
+	if (storedPackets == 0) {
+		return true;
+	}
+	Segment& head = segments[headSegment];
+
+	// If the size of the packet cannot be read, storedBytes keeps counting it rather than becoming wrong
+	if (const auto packetSize = recordPacketSize({headSegment, head.removedRecords})) {
+		storedBytes -= *packetSize;
+	} else {
+		ErrorHandler::reportInternalError(ErrorHandler::PacketStoreReadError);
+	}
+	storedPackets--;
+	head.removedRecords++;
+
+	if (head.removedRecords == head.recordCount) {
+		return releaseHeadSegment();
+	}
+	return writeRemovedRecords();
+}
+
+bool FilePacketStoreBackend::clear() {
+	load();
+	bool isWritten = true;
+	while (usedSegments > 0) {
+		isWritten = releaseHeadSegment() and isWritten;
+	}
+	storedPackets = 0;
+	storedBytes = 0;
+	return isWritten;
+}
+
+size_t FilePacketStoreBackend::packetCount() const {
+	load();
+	return storedPackets;
+}
+
+etl::optional<Time::DefaultCUC> FilePacketStoreBackend::timeTag(size_t position) const {
+	load();
+	const RecordLocation location = locate(position);
+	const Segment& state = segments[location.segment];
+
+	// E.g. the newest packet, which is checked before every new one is stored
+	if ((location.record + 1) == state.recordCount) {
+		return state.lastTimeTag;
+	}
+	if (location.record == 0) {
+		return state.firstTimeTag;
+	}
+	if (cacheRecordOffsets(location.segment, false) <= location.record) {
+		return {};
+	}
+	return timeTagFromValue(recordTimeTags[location.record]);
+}
+
+etl::optional<size_t> FilePacketStoreBackend::lowerBound(Time::DefaultCUC timeTag) const {
+	return findFirstLaterPacket(timeTag, true);
+}
+
+etl::optional<size_t> FilePacketStoreBackend::upperBound(Time::DefaultCUC timeTag) const {
+	return findFirstLaterPacket(timeTag, false);
+}
+
+etl::optional<size_t> FilePacketStoreBackend::findFirstLaterPacket(Time::DefaultCUC timeTag, bool isEqualLater) const {
+	load();
+	const auto isLater = [timeTag, isEqualLater](Time::DefaultCUC recordTimeTag) {
+		return isEqualLater ? not(recordTimeTag < timeTag) : (timeTag < recordTimeTag);
+	};
+
+	// Only the newest segment can be empty, if its first record could not be written
+	uint16_t searchedSegments = usedSegments;
+	if ((searchedSegments > 0) and (segments[tailSegment()].recordCount == 0)) {
+		searchedSegments--;
+	}
+
+	// The first segment whose last record is later holds the packet
+	uint16_t firstSegment = 0;
+	uint16_t count = searchedSegments;
+	while (count > 0) {
+		const uint16_t step = count / 2;
+		if (not isLater(segments[(headSegment + firstSegment + step) % numberOfSegments].lastTimeTag)) {
+			firstSegment += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+	if (firstSegment == searchedSegments) {
+		return storedPackets;
+	}
+
+	size_t position = 0;
+	for (uint16_t i = 0; i < firstSegment; i++) {
+		position += segments[(headSegment + i) % numberOfSegments].recordCount;
+	}
+	const uint16_t segment = (headSegment + firstSegment) % numberOfSegments;
+	if (cacheRecordOffsets(segment, false) < segments[segment].recordCount) {
+		return {};
+	}
+
+	uint16_t firstRecord = (firstSegment == 0) ? segments[headSegment].removedRecords : 0;
+	count = segments[segment].recordCount - firstRecord;
+	while (count > 0) {
+		const uint16_t step = count / 2;
+		if (not isLater(timeTagFromValue(recordTimeTags[firstRecord + step]))) {
+			firstRecord += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+	return position + firstRecord - segments[headSegment].removedRecords;
+}
+
+etl::span<const uint8_t> FilePacketStoreBackend::packet(size_t position) const {
+	load();
+	const RecordLocation location = locate(position);
+	const auto packetSize = recordPacketSize(location);
+	if (not packetSize) {
+		ErrorHandler::reportInternalError(ErrorHandler::PacketStoreReadError);
+		return {};
+	}
+
+	etl::span<uint8_t> packet(recordBuffer.data(), *packetSize);
+	if (Filesystem::readFile(path, segmentOffset(location.segment) + recordOffsets[location.record] + RecordHeaderSize,
+	                         packet)) {
+		ErrorHandler::reportInternalError(ErrorHandler::PacketStoreReadError);
+		return {};
+	}
+	return packet;
+}
+
+uint32_t FilePacketStoreBackend::cumulativeSize(size_t position) const {
+	load();
+	if (position >= storedPackets) {
+		return appendedBytes;
+	}
+	const RecordLocation location = locate(position);
+	cacheRecordOffsets(location.segment, false);
+
+	return segments[location.segment].cumulativeStart + recordOffsets[location.record] - HeaderSize -
+	       location.record * RecordHeaderSize;
+}
+
+uint32_t FilePacketStoreBackend::sizeInBytes() const {
+	load();
+	return storedBytes;
+}
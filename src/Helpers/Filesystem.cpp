@@ -1,4 +1,5 @@
 #include "Filesystem.hpp"
+#include <cstdio>
 
 /**
  * These functions are built on the x86_services target and will never run.
@@ -40,6 +41,41 @@ namespace Filesystem {
 		return etl::nullopt;
 	}
 
+	/**
+	 * Unlike the rest of this file, reading and writing files is implemented with the C standard library, so that
+	 * file-backed packet stores can be used on the host.
+	 */
+	etl::optional<FileAccessError> readFile(const Path& path, uint32_t offset, etl::span<uint8_t> data) {
+		FILE* file = std::fopen(path.c_str(), "rb");
+		if (file == nullptr) {
+			return FileAccessError::FileDoesNotExist;
+		}
+		const bool isRead = (std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0) && // NOLINT(google-runtime-int)
+		                    (std::fread(data.data(), 1, data.size(), file) == data.size());
+		std::fclose(file);
+		if (not isRead) {
+			return FileAccessError::OutOfBounds;
+		}
+		return etl::nullopt;
+	}
+
+	etl::optional<FileAccessError> writeFile(const Path& path, uint32_t offset, etl::span<const uint8_t> data) {
+		FILE* file = std::fopen(path.c_str(), "r+b");
+		if (file == nullptr) {
+			file = std::fopen(path.c_str(), "w+b");
+		}
+		if (file == nullptr) {
+			return FileAccessError::UnknownError;
+		}
+		const bool isWritten = (std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0) && // NOLINT(google-runtime-int)
+		                       (std::fwrite(data.data(), 1, data.size(), file) == data.size());
+		std::fclose(file);
+		if (not isWritten) {
+			return FileAccessError::UnknownError;
+		}
+		return etl::nullopt;
+	}
+
 	uint32_t getUnallocatedMemory() {
 		return 0;
 	}
@@ -1,9 +1,152 @@
 #include "PacketStore.hpp"
 
-uint16_t PacketStore::calculateSizeInBytes() {
-	const uint16_t size = std::accumulate(storedTelemetryPackets.begin(), storedTelemetryPackets.end(), 0, [] // NOLINT (cppcoreguidelines-init-variables)
-	                                      (uint16_t sum, const auto& tmPacket) {
-		return sum + tmPacket.second.data_size_message_;
-	});
-	return size;
+bool PacketStore::storePacket(Time::DefaultCUC timeTag, etl::span<const uint8_t> packet) {
+	if (packet.size() > storage().maxPacketSize()) {
+		return false;
+	}
+	if (not empty() and timeTag < this->timeTag(packetCount() - 1)) {
+		return false;
+	}
+
+	auto result = storage().append(timeTag, packet);
+	while (result == PacketStoreBackend::AppendResult::NoRoom) {
+		if (packetStoreType == Bounded or empty()) {
+			return false;
+		}
+		removeOldestPacket();
+		result = storage().append(timeTag, packet);
+	}
+	if (result == PacketStoreBackend::AppendResult::WriteError) {
+		ErrorHandler::reportInternalError(ErrorHandler::PacketStoreWriteError);
+		return false;
+	}
+
+	// The time-tags never decrease, so the packets up to the end time are always the oldest ones
+	if (not(retrievalEndTime < timeTag)) {
+		byTimeRangeRetrievalEnd = packetCount();
+	}
+	return true;
+}
+
+void PacketStore::removeOldestPacket() {
+	if (empty()) {
+		return;
+	}
+	if (not storage().removeOldest()) {
+		ErrorHandler::reportInternalError(ErrorHandler::PacketStoreWriteError);
+	}
+
+	// The positions of the remaining packets have moved one place to the front
+	if (openRetrievalCursor > 0) {
+		openRetrievalCursor--;
+	}
+	if (byTimeRangeRetrievalCursor > 0) {
+		byTimeRangeRetrievalCursor--;
+	}
+	if (byTimeRangeRetrievalEnd > 0) {
+		byTimeRangeRetrievalEnd--;
+	}
+}
+
+void PacketStore::removePacketsUntil(Time::DefaultCUC timeLimit) {
+	const size_t numberOfPackets = upperBound(timeLimit);
+	for (size_t i = 0; i < numberOfPackets; i++) {
+		removeOldestPacket();
+	}
+}
+
+void PacketStore::clearPackets() {
+	if (not storage().clear()) {
+		ErrorHandler::reportInternalError(ErrorHandler::PacketStoreWriteError);
+	}
+	openRetrievalCursor = 0;
+	byTimeRangeRetrievalCursor = 0;
+	byTimeRangeRetrievalEnd = 0;
+}
+
+Time::DefaultCUC PacketStore::timeTag(size_t position) const {
+	if (const auto storedTimeTag = storage().timeTag(position)) {
+		return *storedTimeTag;
+	}
+	ErrorHandler::reportInternalError(ErrorHandler::PacketStoreReadError);
+
+	for (size_t olderPosition = position; olderPosition > 0; olderPosition--) {
+		if (const auto olderTimeTag = storage().timeTag(olderPosition - 1)) {
+			return *olderTimeTag;
+		}
+	}
+	for (size_t newerPosition = position + 1; newerPosition < packetCount(); newerPosition++) {
+		if (const auto newerTimeTag = storage().timeTag(newerPosition)) {
+			return *newerTimeTag;
+		}
+	}
+	return Time::DefaultCUC(0);
+}
+
+size_t PacketStore::lowerBound(Time::DefaultCUC timeTag) const {
+	if (const auto position = storage().lowerBound(timeTag)) {
+		return *position;
+	}
+
+	size_t first = 0;
+	size_t count = packetCount();
+	while (count > 0) {
+		const size_t step = count / 2;
+		if (this->timeTag(first + step) < timeTag) {
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+	return first;
+}
+
+size_t PacketStore::upperBound(Time::DefaultCUC timeTag) const {
+	if (const auto position = storage().upperBound(timeTag)) {
+		return *position;
+	}
+
+	size_t first = 0;
+	size_t count = packetCount();
+	while (count > 0) {
+		const size_t step = count / 2;
+		if (not(timeTag < this->timeTag(first + step))) {
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+	return first;
+}
+
+void PacketStore::copyPackets(size_t first, size_t last, PacketStore& destination) const {
+	for (size_t i = first; i < last; i++) {
+		destination.storePacket(timeTag(i), packet(i));
+	}
+}
+
+bool PacketStore::nextPacketToRetrieve(etl::span<const uint8_t>& packet) {
+	if (byTimeRangeRetrievalStatus) {
+		if (byTimeRangeRetrievalCursor < byTimeRangeRetrievalEnd) {
+			packet = this->packet(byTimeRangeRetrievalCursor);
+			return true;
+		}
+		byTimeRangeRetrievalStatus = false;
+	}
+
+	if (openRetrievalStatus == InProgress and openRetrievalCursor < packetCount()) {
+		packet = this->packet(openRetrievalCursor);
+		return true;
+	}
+	return false;
+}
+
+void PacketStore::markPacketRetrieved() {
+	if (byTimeRangeRetrievalStatus) {
+		byTimeRangeRetrievalCursor++;
+	} else if (openRetrievalStatus == InProgress) {
+		openRetrievalCursor++;
+	}
 }
@@ -0,0 +1,73 @@
+#include "PacketStoreBackend.hpp"
+
+bool RamPacketStoreBackend::findFreeSpace(uint16_t size, uint16_t& offset) const {
+	if (packetIndex.empty()) {
+		offset = 0;
+		return size <= DataCapacity;
+	}
+
+	const uint16_t oldestOffset = packetIndex.front().offset;
+
+	if (isWrapped) {
+		// The free bytes lie between the newest and the oldest packet
+		offset = writeOffset;
+		return (writeOffset + size) <= oldestOffset;
+	}
+
+	// The free bytes lie after the newest packet, and before the oldest one
+	if ((writeOffset + size) <= DataCapacity) {
+		offset = writeOffset;
+		return true;
+	}
+	offset = 0;
+	return size <= oldestOffset;
+}
+
+PacketStoreBackend::AppendResult RamPacketStoreBackend::append(Time::DefaultCUC timeTag, etl::span<const uint8_t> packet) {
+	if (packet.size() > DataCapacity) {
+		return AppendResult::NoRoom;
+	}
+	const auto size = static_cast<uint16_t>(packet.size());
+
+	uint16_t offset = 0;
+	if (packetIndex.full() or not findFreeSpace(size, offset)) {
+		return AppendResult::NoRoom;
+	}
+
+	if (not packetIndex.empty() and offset < writeOffset) {
+		isWrapped = true;
+	}
+	etl::copy_n(packet.begin(), size, packetData.begin() + offset);
+	packetIndex.push_back({timeTag, offset, size, cumulativeStoredBytes});
+	cumulativeStoredBytes += size;
+	storedBytes += size;
+	writeOffset = offset + size;
+	return AppendResult::Stored;
+}
+
+bool RamPacketStoreBackend::removeOldest() {
+	if (packetIndex.empty()) {
+		return true;
+	}
+
+	const uint16_t removedOffset = packetIndex.front().offset;
+	storedBytes -= packetIndex.front().size;
+	packetIndex.pop_front();
+
+	if (packetIndex.empty()) {
+		writeOffset = 0;
+		isWrapped = false;
+	} else if (packetIndex.front().offset < removedOffset) {
+		// The oldest packet is now at the start of the buffer
+		isWrapped = false;
+	}
+	return true;
+}
+
+bool RamPacketStoreBackend::clear() {
+	packetIndex.clear();
+	storedBytes = 0;
+	writeOffset = 0;
+	isWrapped = false;
+	return true;
+}
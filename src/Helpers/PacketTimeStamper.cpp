@@ -0,0 +1,42 @@
+#include "PacketTimeStamper.hpp"
+#include "TimeGetter.hpp"
+
+void PacketTimeStamper::update(uint32_t epochSeconds, uint32_t fineTime) {
+	// An odd sequence number marks a refresh in progress
+	sequence.fetch_add(1U, std::memory_order_acq_rel);
+	cachedSeconds.store(epochSeconds, std::memory_order_relaxed);
+	cachedFineTime.store(fineTime, std::memory_order_relaxed);
+	sequence.fetch_add(1U, std::memory_order_release);
+
+	isCacheValid.store(true, std::memory_order_release);
+}
+
+void PacketTimeStamper::refresh() {
+	update(static_cast<uint32_t>(TimeGetter::getCurrentTimeUTC().toEpochSeconds() & 0xFFFFFFFFULL), 0U);
+}
+
+void PacketTimeStamper::writeTimeField(uint8_t* field) {
+	uint32_t seconds = 0;
+	uint32_t fineTime = 0;
+
+	if (not isCacheValid.load(std::memory_order_acquire)) {
+		seconds = static_cast<uint32_t>(TimeGetter::getCurrentTimeUTC().toEpochSeconds() & 0xFFFFFFFFULL);
+	} else {
+		uint32_t sequenceBefore = 0;
+		do {
+			sequenceBefore = sequence.load(std::memory_order_acquire);
+			seconds = cachedSeconds.load(std::memory_order_relaxed);
+			fineTime = cachedFineTime.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+		} while (((sequenceBefore & 1U) != 0U) || (sequenceBefore != sequence.load(std::memory_order_relaxed)));
+	}
+
+	field[0] = static_cast<uint8_t>((seconds >> 24U) & 0xFFU);
+	field[1] = static_cast<uint8_t>((seconds >> 16U) & 0xFFU);
+	field[2] = static_cast<uint8_t>((seconds >> 8U) & 0xFFU);
+	field[3] = static_cast<uint8_t>(seconds & 0xFFU);
+	field[4] = static_cast<uint8_t>((fineTime >> 24U) & 0xFFU);
+	field[5] = static_cast<uint8_t>((fineTime >> 16U) & 0xFFU);
+	field[6] = static_cast<uint8_t>((fineTime >> 8U) & 0xFFU);
+	field[7] = static_cast<uint8_t>(fineTime & 0xFFU);
+}
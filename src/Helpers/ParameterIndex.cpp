@@ -0,0 +1,72 @@
+#include "ParameterIndex.hpp"
+#include <etl/array.h>
+#include <etl/bitset.h>
+#include "ErrorHandler.hpp"
+#include "macros.hpp"
+
+namespace {
+	etl::array<ParameterId, ParameterIndex::Capacity> parameterIds{};
+
+	etl::array<PARAMETER_TYPE, ParameterIndex::Capacity> parameterTypes{};
+
+	etl::bitset<ParameterIndex::Capacity> occupiedSlots;
+
+	bool isBuilt = false;
+} // namespace
+
+void ParameterIndex::build() {
+	occupiedSlots.reset();
+
+	// The table is sized for ECSSParameterCount parameters. More of them push its load over 75%, and the ones that do
+	// not fit at all are left out, so that they are reported as non-existent.
+	ASSERT_INTERNAL(PeakSatParameters::parametersArraySize <= ECSSParameterCount, ErrorHandler::InternalErrorType::MapFull);
+
+	uint16_t insertedParameters = 0;
+	for (size_t i = 0; i < PeakSatParameters::parametersArraySize; i++) {
+		const ParameterId parameterId = PeakSatParameters::allParameterIds[i];
+
+		uint16_t slot = hash(parameterId);
+		while (occupiedSlots.test(slot) && (parameterIds[slot] != parameterId)) {
+			slot = (slot + 1U) & (Capacity - 1U);
+		}
+		if (occupiedSlots.test(slot)) {
+			// Duplicate ID
+			continue;
+		}
+		if (insertedParameters == (Capacity - 1U)) {
+			// Always leave one empty slot, so that probing for missing IDs terminates. This only happens with more than
+			// ECSSParameterCount parameters, which has been reported above.
+			break;
+		}
+
+		parameterIds[slot] = parameterId;
+		parameterTypes[slot] = ::getParameterType(parameterId);
+		occupiedSlots.set(slot);
+		insertedParameters++;
+	}
+
+	isBuilt = true;
+}
+
+uint16_t ParameterIndex::findSlot(ParameterId parameterId) {
+	if (not isBuilt) {
+		build();
+	}
+
+	uint16_t slot = hash(parameterId);
+	while (occupiedSlots.test(slot)) {
+		if (parameterIds[slot] == parameterId) {
+			return slot;
+		}
+		slot = (slot + 1U) & (Capacity - 1U);
+	}
+	return NotFound;
+}
+
+PARAMETER_TYPE ParameterIndex::getParameterType(ParameterId parameterId) {
+	const uint16_t slot = findSlot(parameterId);
+	if (slot == NotFound) {
+		return ::getParameterType(parameterId);
+	}
+	return parameterTypes[slot];
+}
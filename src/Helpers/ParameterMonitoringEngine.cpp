@@ -0,0 +1,275 @@
+#include "ParameterMonitoringEngine.hpp"
+
+// The statuses of each check type are computed as an offset from the status of a value within bounds
+static_assert(PMON::BelowLowLimit == PMON::WithinLimits + 1 and PMON::AboveHighLimit == PMON::WithinLimits + 2);
+static_assert(PMON::UnexpectedValue == PMON::ExpectedValue + 1);
+static_assert(PMON::BelowLowThreshold == PMON::WithinThreshold + 1 and
+              PMON::AboveHighThreshold == PMON::WithinThreshold + 2);
+
+namespace {
+	/**
+	 * Returns the monitoring interval of \p definition, where an interval of 0 counts as 1
+	 */
+	PMONMonitoringInterval monitoringIntervalOf(const PMON& definition) {
+		return etl::max(definition.monitoringInterval, PMONMonitoringInterval{1});
+	}
+} // namespace
+
+void ParameterMonitoringEngine::build() {
+	buckets.clear();
+	for (const auto& staged: definitions) {
+		const PMONMonitoringInterval interval = monitoringIntervalOf(*staged.definition);
+		auto bucket = buckets.begin();
+		while ((bucket != buckets.end()) and (bucket->interval < interval)) {
+			++bucket;
+		}
+		if ((bucket != buckets.end()) and (bucket->interval == interval)) {
+			continue;
+		}
+		if (not ASSERT_INTERNAL(not buckets.full(), ErrorHandler::InternalErrorType::MapFull)) {
+			continue;
+		}
+		IntervalBucket newBucket;
+		newBucket.interval = interval;
+		buckets.insert(bucket, newBucket);
+	}
+
+	limitChecks.size = 0;
+	expectedValueChecks.size = 0;
+	deltaChecks.size = 0;
+	for (auto& bucket: buckets) {
+		bucket.limitChecks.begin = limitChecks.size;
+		bucket.expectedValueChecks.begin = expectedValueChecks.size;
+		bucket.deltaChecks.begin = deltaChecks.size;
+		for (const auto& staged: definitions) {
+			if (monitoringIntervalOf(*staged.definition) == bucket.interval) {
+				addRow(staged.pmonId, *staged.definition);
+			}
+		}
+		bucket.limitChecks.end = limitChecks.size;
+		bucket.expectedValueChecks.end = expectedValueChecks.size;
+		bucket.deltaChecks.end = deltaChecks.size;
+	}
+
+	isBuilt = true;
+}
+
+void ParameterMonitoringEngine::addRow(ParameterId pmonId, PMON& definition) {
+	switch (definition.checkType) {
+		case PMON::CheckType::Limit: {
+			auto& limitCheck = static_cast<PMONLimitCheck&>(definition);
+			const uint16_t i = limitChecks.size;
+			if (not ASSERT_INTERNAL(i < limitChecks.definitions.size(), ErrorHandler::InternalErrorType::MapFull)) {
+				return;
+			}
+			limitChecks.definitions[i] = &limitCheck;
+			limitChecks.pmonIds[i] = pmonId;
+			limitChecks.parameterIds[i] = limitCheck.monitoredParameterId;
+			limitChecks.lowLimits[i] = limitCheck.lowLimit;
+			limitChecks.highLimits[i] = limitCheck.highLimit;
+			limitChecks.statuses[i] = limitCheck.checkingStatus;
+			limitChecks.repetitionCounters[i] = limitCheck.repetitionCounter;
+			limitChecks.repetitionNumbers[i] = limitCheck.repetitionNumber;
+			limitChecks.transitionStatuses[i] = limitCheck.checkTransitionList[1];
+			limitChecks.size++;
+			break;
+		}
+		case PMON::CheckType::ExpectedValue: {
+			auto& expectedValueCheck = static_cast<PMONExpectedValueCheck&>(definition);
+			const uint16_t i = expectedValueChecks.size;
+			if (not ASSERT_INTERNAL(i < expectedValueChecks.definitions.size(), ErrorHandler::InternalErrorType::MapFull)) {
+				return;
+			}
+			expectedValueChecks.definitions[i] = &expectedValueCheck;
+			expectedValueChecks.pmonIds[i] = pmonId;
+			expectedValueChecks.parameterIds[i] = expectedValueCheck.monitoredParameterId;
+			expectedValueChecks.masks[i] = expectedValueCheck.mask;
+			expectedValueChecks.expectedValues[i] = expectedValueCheck.expectedValue;
+			expectedValueChecks.statuses[i] = expectedValueCheck.checkingStatus;
+			expectedValueChecks.repetitionCounters[i] = expectedValueCheck.repetitionCounter;
+			expectedValueChecks.repetitionNumbers[i] = expectedValueCheck.repetitionNumber;
+			expectedValueChecks.transitionStatuses[i] = expectedValueCheck.checkTransitionList[1];
+			expectedValueChecks.size++;
+			break;
+		}
+		case PMON::CheckType::Delta: {
+			auto& deltaCheck = static_cast<PMONDeltaCheck&>(definition);
+			const uint16_t i = deltaChecks.size;
+			if (not ASSERT_INTERNAL(i < deltaChecks.definitions.size(), ErrorHandler::InternalErrorType::MapFull)) {
+				return;
+			}
+			deltaChecks.definitions[i] = &deltaCheck;
+			deltaChecks.pmonIds[i] = pmonId;
+			deltaChecks.parameterIds[i] = deltaCheck.monitoredParameterId;
+			deltaChecks.lowThresholds[i] = deltaCheck.lowDeltaThreshold;
+			deltaChecks.highThresholds[i] = deltaCheck.highDeltaThreshold;
+			deltaChecks.statuses[i] = deltaCheck.checkingStatus;
+			deltaChecks.repetitionCounters[i] = deltaCheck.repetitionCounter;
+			deltaChecks.repetitionNumbers[i] = deltaCheck.repetitionNumber;
+			deltaChecks.transitionStatuses[i] = deltaCheck.checkTransitionList[1];
+			deltaChecks.size++;
+			break;
+		}
+	}
+}
+
+void ParameterMonitoringEngine::checkAll() {
+	if (not isBuilt) {
+		build();
+	}
+
+	etl::optional<Time::DefaultCUC> now;
+	for (const auto& bucket: buckets) {
+		if ((tick % bucket.interval) != 0) {
+			continue;
+		}
+		if (not now) {
+			now = TimeGetter::getCurrentTimeDefaultCUC();
+		}
+
+		gatherValues(bucket);
+
+		evaluateLimitChecks(bucket.limitChecks, *now);
+		evaluateExpectedValueChecks(bucket.expectedValueChecks, *now);
+		evaluateDeltaChecks(bucket.deltaChecks, *now);
+
+		storeResults(bucket);
+	}
+	tick++;
+}
+
+void ParameterMonitoringEngine::gatherValues(const IntervalBucket& bucket) {
+	for (uint16_t i = bucket.limitChecks.begin; i < bucket.limitChecks.end; i++) {
+		auto value = MemoryManager::getParameterAsDOUBLE(limitChecks.parameterIds[i]);
+		limitChecks.isValueValid[i] = value.has_value();
+		limitChecks.values[i] = value.has_value() ? value.value() : 0;
+	}
+	for (uint16_t i = bucket.expectedValueChecks.begin; i < bucket.expectedValueChecks.end; i++) {
+		auto value = MemoryManager::getParameterAsUINT64(expectedValueChecks.parameterIds[i]);
+		expectedValueChecks.isValueValid[i] = value.has_value();
+		expectedValueChecks.values[i] = value.has_value() ? value.value() : 0;
+	}
+	for (uint16_t i = bucket.deltaChecks.begin; i < bucket.deltaChecks.end; i++) {
+		auto value = MemoryManager::getParameterAsDOUBLE(deltaChecks.parameterIds[i]);
+		deltaChecks.isValueValid[i] = value.has_value();
+		deltaChecks.values[i] = value.has_value() ? value.value() : 0;
+	}
+}
+
+void ParameterMonitoringEngine::evaluateLimitChecks(RowRange rows, Time::DefaultCUC now) {
+	for (uint16_t i = rows.begin; i < rows.end; i++) {
+		const double value = limitChecks.values[i];
+		const auto isBelowLowLimit = static_cast<uint8_t>(value < limitChecks.lowLimits[i]);
+		const auto isAboveHighLimit = static_cast<uint8_t>(value > limitChecks.highLimits[i]);
+		const auto limitStatus =
+		    static_cast<PMON::CheckingStatus>(PMON::WithinLimits + isBelowLowLimit + 2U * isAboveHighLimit);
+		const PMON::CheckingStatus status = limitChecks.isValueValid[i] ? limitStatus : PMON::Invalid;
+
+		limitChecks.repetitionCounters[i] =
+		    countRepetition(limitChecks.statuses[i], status, limitChecks.repetitionCounters[i]);
+		limitChecks.statuses[i] = status;
+
+		if (isTransition(limitChecks.transitionStatuses[i], status, limitChecks.repetitionCounters[i],
+		                 limitChecks.repetitionNumbers[i])) {
+			// When the value returns within the limits, the crossed limit is the one that it was beyond
+			const bool isHighLimitCrossed = (status == PMON::AboveHighLimit) or
+			                                ((status != PMON::BelowLowLimit) and
+			                                 (limitChecks.transitionStatuses[i] == PMON::AboveHighLimit));
+			CheckTransition transition;
+			transition.value = value;
+			transition.limitCrossed = isHighLimitCrossed ? limitChecks.highLimits[i] : limitChecks.lowLimits[i];
+			recordTransition(limitChecks.pmonIds[i], *limitChecks.definitions[i], limitChecks.transitionStatuses[i],
+			                 status, now, transition);
+		}
+	}
+}
+
+void ParameterMonitoringEngine::evaluateExpectedValueChecks(RowRange rows, Time::DefaultCUC now) {
+	for (uint16_t i = rows.begin; i < rows.end; i++) {
+		const auto isUnexpected = static_cast<uint8_t>((expectedValueChecks.values[i] & expectedValueChecks.masks[i]) !=
+		                                               expectedValueChecks.expectedValues[i]);
+		const auto expectedValueStatus = static_cast<PMON::CheckingStatus>(PMON::ExpectedValue + isUnexpected);
+		const PMON::CheckingStatus status = expectedValueChecks.isValueValid[i] ? expectedValueStatus : PMON::Invalid;
+
+		expectedValueChecks.repetitionCounters[i] =
+		    countRepetition(expectedValueChecks.statuses[i], status, expectedValueChecks.repetitionCounters[i]);
+		expectedValueChecks.statuses[i] = status;
+
+		if (isTransition(expectedValueChecks.transitionStatuses[i], status, expectedValueChecks.repetitionCounters[i],
+		                 expectedValueChecks.repetitionNumbers[i])) {
+			CheckTransition transition;
+			transition.mask = expectedValueChecks.masks[i];
+			transition.unsignedValue = expectedValueChecks.values[i];
+			transition.expectedValue = expectedValueChecks.expectedValues[i];
+			recordTransition(expectedValueChecks.pmonIds[i], *expectedValueChecks.definitions[i],
+			                 expectedValueChecks.transitionStatuses[i], status, now, transition);
+		}
+	}
+}
+
+void ParameterMonitoringEngine::evaluateDeltaChecks(RowRange rows, Time::DefaultCUC now) {
+	const PMONDeltaCheck::SampleTime nowTicks = now.formatAsBytes();
+	for (uint16_t i = rows.begin; i < rows.end; i++) {
+		PMON::CheckingStatus status = PMON::Invalid;
+		double deltaPerSecond = 0;
+
+		etl::optional<double> averageDeltaPerSecond;
+		if (deltaChecks.isValueValid[i]) {
+			averageDeltaPerSecond = deltaChecks.definitions[i]->addSample(deltaChecks.values[i], nowTicks);
+		}
+		if (averageDeltaPerSecond) {
+			deltaPerSecond = *averageDeltaPerSecond;
+			const auto isBelowLowThreshold = static_cast<uint8_t>(deltaPerSecond < deltaChecks.lowThresholds[i]);
+			const auto isAboveHighThreshold = static_cast<uint8_t>(deltaPerSecond > deltaChecks.highThresholds[i]);
+			status = static_cast<PMON::CheckingStatus>(PMON::WithinThreshold + isBelowLowThreshold +
+			                                           2U * isAboveHighThreshold);
+		}
+
+		deltaChecks.repetitionCounters[i] =
+		    countRepetition(deltaChecks.statuses[i], status, deltaChecks.repetitionCounters[i]);
+		deltaChecks.statuses[i] = status;
+
+		if (isTransition(deltaChecks.transitionStatuses[i], status, deltaChecks.repetitionCounters[i],
+		                 deltaChecks.repetitionNumbers[i])) {
+			const bool isHighThresholdCrossed = (status == PMON::AboveHighThreshold) or
+			                                    ((status != PMON::BelowLowThreshold) and
+			                                     (deltaChecks.transitionStatuses[i] == PMON::AboveHighThreshold));
+			CheckTransition transition;
+			transition.value = deltaPerSecond;
+			transition.limitCrossed =
+			    isHighThresholdCrossed ? deltaChecks.highThresholds[i] : deltaChecks.lowThresholds[i];
+			recordTransition(deltaChecks.pmonIds[i], *deltaChecks.definitions[i], deltaChecks.transitionStatuses[i],
+			                 status, now, transition);
+		}
+	}
+}
+
+void ParameterMonitoringEngine::recordTransition(ParameterId pmonId, PMON& definition,
+                                                 PMON::CheckingStatus& transitionStatus, PMON::CheckingStatus status,
+                                                 Time::DefaultCUC now, CheckTransition& transition) {
+	transition.pmonId = pmonId;
+	transition.monitoredParameterId = definition.monitoredParameterId;
+	transition.checkType = definition.checkType;
+	transition.previousStatus = transitionStatus;
+	transition.currentStatus = status;
+	transition.transitionTime = now;
+	checkTransitions.push(transition);
+
+	definition.checkTransitionList = {transitionStatus, status};
+	transitionStatus = status;
+}
+
+void ParameterMonitoringEngine::storeResults(const IntervalBucket& bucket) {
+	for (uint16_t i = bucket.limitChecks.begin; i < bucket.limitChecks.end; i++) {
+		limitChecks.definitions[i]->checkingStatus = limitChecks.statuses[i];
+		limitChecks.definitions[i]->repetitionCounter = limitChecks.repetitionCounters[i];
+	}
+	for (uint16_t i = bucket.expectedValueChecks.begin; i < bucket.expectedValueChecks.end; i++) {
+		expectedValueChecks.definitions[i]->checkingStatus = expectedValueChecks.statuses[i];
+		expectedValueChecks.definitions[i]->repetitionCounter = expectedValueChecks.repetitionCounters[i];
+	}
+	for (uint16_t i = bucket.deltaChecks.begin; i < bucket.deltaChecks.end; i++) {
+		deltaChecks.definitions[i]->checkingStatus = deltaChecks.statuses[i];
+		deltaChecks.definitions[i]->repetitionCounter = deltaChecks.repetitionCounters[i];
+	}
+}
@@ -1,5 +1,16 @@
 #include "Statistic.hpp"
 #include <cmath>
+#include "etl/algorithm.h"
+
+namespace {
+	/**
+	 * Adds \p samples to a sample counter that stops at the largest \ref ParameterSampleCount
+	 */
+	ParameterSampleCount addSamples(ParameterSampleCount sampleCounter, size_t samples) {
+		constexpr size_t MaxSampleCount = std::numeric_limits<ParameterSampleCount>::max();
+		return static_cast<ParameterSampleCount>(etl::min(sampleCounter + samples, MaxSampleCount));
+	}
+} // namespace
 
 void Statistic::updateStatistics(double value) {
 	if (value > max) {
@@ -10,11 +21,60 @@ void Statistic::updateStatistics(double value) {
 		min = value;
 		timeOfMinValue = TimeGetter::getCurrentTimeDefaultCUC();
 	}
-	if (sampleCounter + 1 > 0) {  //cppcheck-suppress knownConditionTrueFalse
-		mean = (mean * sampleCounter + value) / (sampleCounter + 1);
+
+	accumulatedSamples++;
+	const double deviation = value - mean;
+	mean += deviation / accumulatedSamples;
+	sumOfSquaredDeviations += deviation * (value - mean);
+	sampleCounter = addSamples(sampleCounter, 1);
+}
+
+void Statistic::updateStatistics(etl::span<const double> values) {
+	if (values.empty()) {
+		return;
+	}
+
+	double blockMax = -std::numeric_limits<double>::infinity();
+	double blockMin = std::numeric_limits<double>::infinity();
+	double blockSum = 0;
+	for (const double value: values) {
+		blockMax = etl::max(blockMax, value);
+		blockMin = etl::min(blockMin, value);
+		blockSum += value;
+	}
+	const auto blockSamples = static_cast<double>(values.size());
+	const double blockMean = blockSum / blockSamples;
+
+	// Second pass over the block, with the rounding error of blockMean removed by the sum of the deviations
+	double blockSumOfDeviations = 0;
+	double blockSumOfSquaredDeviations = 0;
+	for (const double value: values) {
+		const double deviation = value - blockMean;
+		blockSumOfDeviations += deviation;
+		blockSumOfSquaredDeviations += deviation * deviation;
 	}
-	sumOfSquares += pow(value, 2);
-	sampleCounter++;
+	blockSumOfSquaredDeviations -= blockSumOfDeviations * blockSumOfDeviations / blockSamples;
+
+	if ((blockMax > max) or (blockMin < min)) {
+		const Time::DefaultCUC now = TimeGetter::getCurrentTimeDefaultCUC();
+		if (blockMax > max) {
+			max = blockMax;
+			timeOfMaxValue = now;
+		}
+		if (blockMin < min) {
+			min = blockMin;
+			timeOfMinValue = now;
+		}
+	}
+
+	// Merge the block with the previous samples (Chan et al.)
+	const auto previousSamples = static_cast<double>(accumulatedSamples);
+	accumulatedSamples += values.size();
+	const double blockWeight = blockSamples / accumulatedSamples;
+	const double deviation = blockMean - mean;
+	mean += deviation * blockWeight;
+	sumOfSquaredDeviations += blockSumOfSquaredDeviations + deviation * deviation * previousSamples * blockWeight;
+	sampleCounter = addSamples(sampleCounter, values.size());
 }
 
 void Statistic::appendStatisticsToMessage(Message& report) const {
@@ -26,11 +86,8 @@ void Statistic::appendStatisticsToMessage(Message& report) const {
 
 	if constexpr (SupportsStandardDeviation) {
 		double standardDeviation = 0;
-		if (sampleCounter == 0) {
-			standardDeviation = 0;
-		} else {
-			const double meanOfSquares = sumOfSquares / sampleCounter;
-			standardDeviation = sqrt(abs(meanOfSquares - pow(mean, 2))); // NOLINT(bugprone-narrowing-conversions,cppcoreguidelines-narrowing-conversions
+		if (accumulatedSamples != 0) {
+			standardDeviation = std::sqrt(etl::max(sumOfSquaredDeviations, 0.0) / accumulatedSamples);
 		}
 		report.appendFloat(static_cast<float>(standardDeviation));
 	}
@@ -46,12 +103,13 @@ void Statistic::resetStatistics() {
 	timeOfMaxValue = Time::DefaultCUC(0);
 	timeOfMinValue = Time::DefaultCUC(0);
 	mean = 0;
-	sumOfSquares = 0;
+	sumOfSquaredDeviations = 0;
+	accumulatedSamples = 0;
 	sampleCounter = 0;
 }
 
 bool Statistic::statisticsAreInitialized() const {
-	return (sampleCounter == 0 and mean == 0 and sumOfSquares == 0 and
+	return (sampleCounter == 0 and accumulatedSamples == 0 and mean == 0 and sumOfSquaredDeviations == 0 and
 	        timeOfMaxValue == Time::DefaultCUC(0) and timeOfMinValue == Time::DefaultCUC(0) and
 	        max == -std::numeric_limits<double>::infinity() and min == std::numeric_limits<double>::infinity());
 }
@@ -2,6 +2,7 @@
 #include <ServicePool.hpp>
 #include "CRCHelper.hpp"
 #include "ErrorHandler.hpp"
+#include "PacketTimeStamper.hpp"
 #include "RequestVerificationService.hpp"
 #include "macros.hpp"
 
@@ -10,91 +11,170 @@ static_assert(sizeof(ServiceTypeNum) == 1);
 
 static_assert(sizeof(MessageTypeNum) == 1);
 
-void MessageParser::execute(Message& message) { //cppcheck-suppress[constParameter,constParameterReference]
-	switch (message.serviceType) {
+static_assert(ECSSSecondaryTMHeaderSize == (7 + PacketTimeStamper::TimeFieldSize), "The time field ends the TM secondary header");
+
+namespace {
+	/**
+	 * The number of possible service type values, i.e. the size of the dispatch table
+	 */
+	constexpr uint16_t ServiceTypeCount = 256U;
+
+	/**
+	 * A function that forwards a TC to the `execute()` function of one of the services
+	 */
+	using ServiceHandler = void (*)(Message&);
+
+	/**
+	 * Forwards \p message to the service stored in \p ServiceMember of the global \ref ServicePool
+	 */
+	template <auto ServiceMember>
+	void executeService(Message& message) {
+		(Services.*ServiceMember).execute(message);
+	}
+
+	/**
+	 * Builds the service type -> handler table out of the services enabled in \ref ECSS_Configuration.hpp.
+	 * Entries of disabled or unknown services are left empty.
+	 */
+	constexpr etl::array<ServiceHandler, ServiceTypeCount> generateServiceHandlers() {
+		etl::array<ServiceHandler, ServiceTypeCount> handlers{};
 
 #ifdef SERVICE_HOUSEKEEPING
-		case HousekeepingService::ServiceType:
-			Services.housekeeping.execute(message);
-			break;
+		handlers[HousekeepingService::ServiceType] = &executeService<&ServicePool::housekeeping>;
 #endif
 
 #ifdef SERVICE_PARAMETERSTATISTICS
-		case ParameterStatisticsService::ServiceType:
-			Services.parameterStatistics.execute(message);
-			break;
+		handlers[ParameterStatisticsService::ServiceType] = &executeService<&ServicePool::parameterStatistics>;
 #endif
 
 #ifdef SERVICE_EVENTREPORT
-		case EventReportService::ServiceType:
-			Services.eventReport.execute(message);
-			break;
+		handlers[EventReportService::ServiceType] = &executeService<&ServicePool::eventReport>;
 #endif
 
 #ifdef SERVICE_MEMORY
-		case MemoryManagementService::ServiceType:
-			Services.memoryManagement.execute(message);
-			break;
+		handlers[MemoryManagementService::ServiceType] = &executeService<&ServicePool::memoryManagement>;
 #endif
 
 #ifdef SERVICE_FUNCTION
-		case FunctionManagementService::ServiceType:
-			Services.functionManagement.execute(message);
-			break;
+		handlers[FunctionManagementService::ServiceType] = &executeService<&ServicePool::functionManagement>;
 #endif
 
 #ifdef SERVICE_TIMESCHEDULING
-		case TimeBasedSchedulingService::ServiceType:
-			Services.timeBasedScheduling.execute(message);
-			break;
+		handlers[TimeBasedSchedulingService::ServiceType] = &executeService<&ServicePool::timeBasedScheduling>;
 #endif
 
 #ifdef SERVICE_STORAGEANDRETRIEVAL
-		case StorageAndRetrievalService::ServiceType:
-			Services.storageAndRetrieval.execute(message);
+		handlers[StorageAndRetrievalService::ServiceType] = &executeService<&ServicePool::storageAndRetrieval>;
 #endif
 
 #ifdef SERVICE_ONBOARDMONITORING
-		case OnBoardMonitoringService::ServiceType:
-			Services.onBoardMonitoringService.execute(message);
-			break;
+		handlers[OnBoardMonitoringService::ServiceType] = &executeService<&ServicePool::onBoardMonitoringService>;
 #endif
 
 #ifdef SERVICE_TEST
-		case TestService::ServiceType:
-			Services.testService.execute(message);
-			break;
+		handlers[TestService::ServiceType] = &executeService<&ServicePool::testService>;
 #endif
 
 #ifdef SERVICE_EVENTACTION
-		case EventActionService::ServiceType:
-			Services.eventAction.execute(message);
-			break;
+		handlers[EventActionService::ServiceType] = &executeService<&ServicePool::eventAction>;
 #endif
 
 #ifdef SERVICE_PARAMETER
-		case ParameterService::ServiceType:
-			Services.parameterManagement.execute(message);
-			break;
+		handlers[ParameterService::ServiceType] = &executeService<&ServicePool::parameterManagement>;
 #endif
 
 #ifdef SERVICE_REALTIMEFORWARDINGCONTROL
-		case RealTimeForwardingControlService::ServiceType:
-			Services.realTimeForwarding.execute(message);
-			break;
+		handlers[RealTimeForwardingControlService::ServiceType] = &executeService<&ServicePool::realTimeForwarding>;
 #endif
 
 #ifdef SERVICE_FILE_MANAGEMENT
-		case FileManagementService::ServiceType:
-			Services.fileManagement.execute(message); // ST[23]
-			break;
+		handlers[FileManagementService::ServiceType] = &executeService<&ServicePool::fileManagement>;
+#endif
+
+#ifdef SERVICE_LARGEPACKET
+		handlers[LargePacketTransferService::ServiceType] = &executeService<&ServicePool::largePacketTransferService>;
 #endif
-		case LargePacketTransferService::ServiceType:
-			Services.largePacketTransferService.execute(message);
+
+		return handlers;
+	}
+
+	constexpr etl::array<ServiceHandler, ServiceTypeCount> ServiceHandlers = generateServiceHandlers();
+} // namespace
+
+void MessageParser::execute(Message& message) { //cppcheck-suppress[constParameter,constParameterReference]
+	const ServiceHandler handler = ServiceHandlers[message.serviceType];
+	if (handler == nullptr) {
+		ErrorHandler::reportInternalError(ErrorHandler::OtherMessageType);
+		return;
+	}
+
+	// Every TC passes through here, so this is the place to attach any per-handler instrumentation
+	handler(message);
+}
+
+MessageParser::BatchStatus MessageParser::parseAndExecuteBatch(const uint8_t* data, uint32_t length, bool error_reporting_active,
+                                                               uint32_t& consumedLength) {
+	BatchStatus status;
+	consumedLength = 0;
+	if (data == nullptr) {
+		return status;
+	}
+
+	// The boundaries of each packet within the buffer
+	etl::vector<uint32_t, ECSSMaxTCBatchSize> packetOffsets;
+	etl::vector<uint32_t, ECSSMaxTCBatchSize> packetLengths;
+	const uint16_t crcSize = CRCHelper::EnableCRC ? CRCField : 0U;
+
+	// First pass: split the buffer and validate all CRCs while the headers are still in cache
+	uint32_t offset = 0;
+	while (not status.full()) {
+		const uint32_t remaining = length - offset;
+		if (remaining == 0U) {
+			break;
+		}
+		if (remaining < CCSDSPrimaryHeaderSize) {
+			status.push_back(OBDH_ERROR_MESSAGE_PARSER_PARSE_LENGTH_LESS_THAN_EXPECTED);
+			break;
+		}
+
+		const uint16_t packetCCSDSDataLength = (data[offset + 4] << 8) | data[offset + 5];
+		const uint32_t packetLength = CCSDSPrimaryHeaderSize + packetCCSDSDataLength + 1U + crcSize;
+		if (packetLength > remaining) {
+			status.push_back(OBDH_ERROR_MESSAGE_PARSER_PARSE_LENGTH_LESS_THAN_EXPECTED);
 			break;
-		default:
-			ErrorHandler::reportInternalError(ErrorHandler::OtherMessageType);
+		}
+
+		if (CRCHelper::EnableCRC && (CRCHelper::validateCRC(data + offset, packetLength) != 0U)) {
+			status.push_back(OBDH_ERROR_INVALID_ARGUMENT);
+		} else {
+			status.push_back(GENERIC_ERROR_NONE);
+		}
+		packetOffsets.push_back(offset);
+		packetLengths.push_back(packetLength - crcSize);
+		offset += packetLength;
+	}
+	consumedLength = offset;
+
+	// Second pass: parse and dispatch every valid packet, reusing the same Message
+	Message message;
+	for (size_t i = 0; i < packetOffsets.size(); i++) {
+		if (status[i] != GENERIC_ERROR_NONE) {
+			continue;
+		}
+
+		status[i] = parse(data + packetOffsets[i], packetLengths[i], message, error_reporting_active, true);
+		if (status[i] != GENERIC_ERROR_NONE) {
+			continue;
+		}
+		if (message.packet_type_ != Message::TC) {
+			status[i] = OBDH_ERROR_MESSAGE_PARSER_WRONG_USAGE;
+			continue;
+		}
+
+		execute(message);
 	}
+
+	return status;
 }
 
 SpacecraftErrorCode MessageParser::parse(const uint8_t* data, uint32_t length, Message& message, bool error_reporting_active, bool parse_ccsds) {
@@ -103,7 +183,41 @@ SpacecraftErrorCode MessageParser::parse(const uint8_t* data, uint32_t length, M
 	}
 	if (parse_ccsds == false) {
 		return OBDH_ERROR_MESSAGE_PARSER_WRONG_USAGE;
+	}
 
+	MessageView view;
+	const SpacecraftErrorCode error = parseView(data, length, view, error_reporting_active);
+	if (error != GENERIC_ERROR_NONE) {
+		return error;
+	}
+
+	// Reset the message in place, instead of assigning a new Message which zero-initialises and then copies the data
+	message.serviceType = view.serviceType;
+	message.messageType = view.messageType;
+	message.packet_type_ = view.packet_type_;
+	message.application_ID_ = view.application_ID_;
+	message.source_ID_ = view.source_ID_;
+	message.message_type_counter_ = 0;
+	message.packet_sequence_count_ = view.packet_sequence_count_;
+	message.total_size_ccsds_ = view.total_size_ccsds_;
+	message.total_size_ecss_ = view.total_size_ecss_;
+	message.data_size_ecss_ = view.data_size_ecss_;
+	message.data_size_message_ = view.data_size_ecss_;
+	message.function_id_ = 0;
+	message.currentBit = 0;
+	message.readPosition = 0;
+
+	// The user data field is copied once, straight from the receive buffer. The rest is cleared, since appending
+	// bits and comparing messages rely on the unused bytes being 0.
+	etl::copy_n(view.data, view.data_size_ecss_, message.data.begin());
+	etl::fill(message.data.begin() + view.data_size_ecss_, message.data.end(), 0);
+
+	return GENERIC_ERROR_NONE;
+}
+
+SpacecraftErrorCode MessageParser::parseView(const uint8_t* data, uint32_t length, MessageView& view, bool error_reporting_active) {
+	if (data == nullptr || length < CCSDSPrimaryHeaderSize) {
+		return OBDH_ERROR_MESSAGE_PARSER_PARSE_LENGTH_LESS_THAN_EXPECTED;
 	}
 	uint16_t const packetHeaderIdentification = (data[0] << 8) | data[1];
 	uint16_t const packetSequenceControl = (data[2] << 8) | data[3];
@@ -118,12 +232,13 @@ SpacecraftErrorCode MessageParser::parse(const uint8_t* data, uint32_t length, M
 	// - Bits 10-9 (2 MSBs): application_ID
 	// - Bits 8-0 (9 LSBs): spacecraftID
 	uint8_t const application_ID = (APID >> 9U) & 0x3U;        // Extract bits 10-9
-	uint16_t const spacecraftID = APID & 0x1FFU;                   // Extract bits 8-0
 
 	auto sequenceFlags = static_cast<uint8_t>(packetSequenceControl >> 14);
 	SequenceCount const packetSequenceCount = packetSequenceControl & (~0xc000U);
 
-	message = Message(0, 0, packet_type, application_ID);
+	view = MessageView();
+	view.packet_type_ = packet_type;
+	view.application_ID_ = application_ID;
 
 	if ((packet_type == Message::TM) && (length < ECSSSecondaryTMHeaderSize)) {
 		return OBDH_ERROR_MESSAGE_PARSER_TM_SIZE_LESS_THAN_EXPECTED;
@@ -141,40 +256,39 @@ SpacecraftErrorCode MessageParser::parse(const uint8_t* data, uint32_t length, M
 			return OBDH_ERROR_MESSAGE_PARSER_PARSE_SEQUENCE_FLAGS;
 	}
 
-	message.packet_sequence_count_ = packetSequenceCount;
+	view.packet_sequence_count_ = packetSequenceCount;
 
 	if (packetCCSDSDataLength > ECSSMaxMessageSize)
 		return OBDH_ERROR_MESSAGE_PARSER_TC_SIZE_LARGER_THAN_EXPECTED;
-	//
-	message.total_size_ccsds_ = length;
-	message.total_size_ecss_ = message.total_size_ccsds_ - CCSDSPrimaryHeaderSize;
-	//
-	if (message.packet_type_ == Message::TM) {
-		message.data_size_ecss_ = message.total_size_ecss_ - ECSSSecondaryTMHeaderSize;
-	}
-	if (message.packet_type_ == Message::TC) {
-		message.data_size_ecss_ = message.total_size_ecss_ - ECSSSecondaryTCHeaderSize;
-	}
-
-	message.data_size_message_ = message.total_size_ecss_;
 
-	etl::array<uint8_t, ECSSMaxMessageSize> ecss_data{};
-
-	// Validate bounds before copying
-	if (CCSDSPrimaryHeaderSize + message.total_size_ecss_ > length) {
-		return OBDH_ERROR_MESSAGE_PARSER_PARSE_LENGTH_LESS_THAN_EXPECTED;
-	}
-	if (message.total_size_ecss_ > ECSSMaxMessageSize) {
+	const uint32_t totalSizeECSS = length - CCSDSPrimaryHeaderSize;
+	if (totalSizeECSS > ECSSMaxMessageSize) {
 		return OBDH_ERROR_MESSAGE_PARSER_DATA_TOO_LARGE;
 	}
-	etl::copy_n(&data[CCSDSPrimaryHeaderSize],
-	            message.total_size_ecss_,
-	            ecss_data.data());
+	view.total_size_ccsds_ = length;
+	view.total_size_ecss_ = totalSizeECSS;
+
+	// Decode the ECSS secondary header straight from the receive buffer
+	const uint8_t* ecssData = data + CCSDSPrimaryHeaderSize;
+	const uint16_t secondaryHeaderSize = (packet_type == Message::TC) ? ECSSSecondaryTCHeaderSize : ECSSSecondaryTMHeaderSize;
+	if (totalSizeECSS < secondaryHeaderSize) {
+		return (packet_type == Message::TC) ? OBDH_ERROR_MESSAGE_PARSER_TC_SIZE_LESS_THAN_EXPECTED
+		                                    : OBDH_ERROR_MESSAGE_PARSER_TM_SIZE_LESS_THAN_EXPECTED;
+	}
+
+	uint8_t const pusVersion = ecssData[0] >> 4;
+	if (pusVersion != 2U)
+		return OBDH_ERROR_MESSAGE_PARSER_PARSE_WRONG_PUS_VERSION;
 
+	view.serviceType = ecssData[1];
+	view.messageType = ecssData[2];
 	if (packet_type == Message::TC) {
-		return parseECSSTCHeader(ecss_data.data(), message);
+		view.source_ID_ = (ecssData[3] << 8) + ecssData[4];
 	}
-	return parseECSSTMHeader(ecss_data.data(), message.total_size_ecss_, message);
+	view.data_size_ecss_ = totalSizeECSS - secondaryHeaderSize;
+	view.data = ecssData + secondaryHeaderSize;
+
+	return GENERIC_ERROR_NONE;
 }
 
 
@@ -218,10 +332,7 @@ SpacecraftErrorCode MessageParser::parseECSSTC(const uint8_t* data, Message& mes
 	return parseECSSTCHeader(data, message);
 }
 
-etl::expected<String<CCSDSMaxMessageSize>, SpacecraftErrorCode> MessageParser::composeECSS(Message& message, uint16_t ecss_total_size) {
-	// We will create an array with the maximum size.
-	etl::array<uint8_t, ECSSSecondaryTMHeaderSize> header = {};
-
+uint16_t MessageParser::writeECSSHeader(const Message& message, uint8_t* header) {
 	if (message.packet_type_ == Message::TC) {
 		header[0] = ECSSPUSVersion << 4U; // Assign the pusVersion = 2
 		header[0] |= 0x00;                // Ack flags
@@ -229,34 +340,30 @@ etl::expected<String<CCSDSMaxMessageSize>, SpacecraftErrorCode> MessageParser::c
 		header[2] = message.messageType;
 		header[3] = message.application_ID_ >> 8U;
 		header[4] = message.application_ID_;
-	} else {
-		header[0] = ECSSPUSVersion << 4U; // Assign the pusVersion = 2
-		header[0] |= 0x00;                // Spacecraft time reference status
-		header[1] = message.serviceType;
-		header[2] = message.messageType;
-		header[3] = static_cast<uint8_t>(message.message_type_counter_ >> 8U);
-		header[4] = static_cast<uint8_t>(message.message_type_counter_ & 0xffU);
-		header[5] = message.application_ID_ >> 8U; // DestinationID
-		header[6] = message.application_ID_;
-		const uint64_t epochSeconds = TimeGetter::getCurrentTimeUTC().toEpochSeconds();
-
-		// Format as 4-byte value for header (masking to 32 bits)
-		const auto ticks = static_cast<uint32_t>(epochSeconds & 0xFFFFFFFFULL);
-		header[7] = static_cast<uint8_t>((ticks >> 24) & 0xFFU);
-		header[8] = static_cast<uint8_t>((ticks >> 16) & 0xFFU);
-		header[9] = static_cast<uint8_t>((ticks >> 8) & 0xFFU);
-		header[10] = static_cast<uint8_t>(ticks & 0xFFU);
-		header[11] = 0;
-		header[12] = 0;
-		header[13] = 0;
-		header[14] = 0;
+		return ECSSSecondaryTCHeaderSize;
 	}
 
-	String<CCSDSMaxMessageSize> outData(header.data(), ((message.packet_type_ == Message::TM) ? ECSSSecondaryTMHeaderSize : ECSSSecondaryTCHeaderSize));
-	if (message.packet_type_ == Message::TC) {
-		outData.append(message.data.begin(), ecss_total_size - ECSSSecondaryTCHeaderSize);
-	} else if (message.packet_type_ == Message::TM) {
-		outData.append(message.data.begin(), ecss_total_size - ECSSSecondaryTMHeaderSize);
+	header[0] = ECSSPUSVersion << 4U; // Assign the pusVersion = 2
+	header[0] |= 0x00;                // Spacecraft time reference status
+	header[1] = message.serviceType;
+	header[2] = message.messageType;
+	header[3] = static_cast<uint8_t>(message.message_type_counter_ >> 8U);
+	header[4] = static_cast<uint8_t>(message.message_type_counter_ & 0xffU);
+	header[5] = message.application_ID_ >> 8U; // DestinationID
+	header[6] = message.application_ID_;
+	// Seconds in bytes 7 to 10, fine time in bytes 11 to 14
+	PacketTimeStamper::writeTimeField(&header[7]);
+	return ECSSSecondaryTMHeaderSize;
+}
+
+etl::expected<String<CCSDSMaxMessageSize>, SpacecraftErrorCode> MessageParser::composeECSS(Message& message, uint16_t ecss_total_size) {
+	// We will create an array with the maximum size.
+	etl::array<uint8_t, ECSSSecondaryTMHeaderSize> header = {};
+	const uint16_t headerSize = writeECSSHeader(message, header.data());
+
+	String<CCSDSMaxMessageSize> outData(header.data(), headerSize);
+	if (message.packet_type_ == Message::TC || message.packet_type_ == Message::TM) {
+		outData.append(message.data.begin(), ecss_total_size - headerSize);
 	}
 
 	// Make sure to reach the requested size
@@ -275,28 +382,34 @@ etl::expected<String<CCSDSMaxMessageSize>, SpacecraftErrorCode> MessageParser::c
 }
 
 etl::expected<String<CCSDSMaxMessageSize>, SpacecraftErrorCode> MessageParser::compose(Message& message, uint16_t total_eccs_size) {
+	// Large enough for the headers and the CRC, even when the size exceeds the capacity of the returned String
+	etl::array<uint8_t, CCSDSMaxMessageSize + CCSDSPrimaryHeaderSize + CRCField> packet; // NOLINT(cppcoreguidelines-pro-type-member-init)
 
+	auto result = compose(message, total_eccs_size, etl::span<uint8_t>(packet));
+	if (!result.has_value()) {
+		return etl::unexpected(result.error());
+	}
+
+	return String<CCSDSMaxMessageSize>(packet.data(), etl::min<size_t>(result.value(), CCSDSMaxMessageSize));
+}
+
+etl::expected<uint16_t, SpacecraftErrorCode> MessageParser::compose(Message& message, uint16_t total_eccs_size, etl::span<uint8_t> out) {
 	if (total_eccs_size > CCSDSMaxMessageSize - CCSDSPrimaryHeaderSize) {
 		return etl::unexpected(OBDH_ERROR_MESSAGE_PARSER_COMPOSE_DATA_SIZE_LARGER_THAN_EXPECTED);
 	}
-	message.total_size_ecss_ = total_eccs_size;
-	if (message.packet_type_ == Message::TC) {
-		message.data_size_ecss_ = total_eccs_size - ECSSSecondaryTCHeaderSize;
+	const uint16_t secondaryHeaderSize = (message.packet_type_ == Message::TC) ? ECSSSecondaryTCHeaderSize : ECSSSecondaryTMHeaderSize;
+	if (total_eccs_size < secondaryHeaderSize) {
+		return etl::unexpected(OBDH_ERROR_INVALID_ARGUMENT);
 	}
-
-	if (message.packet_type_ == Message::TM) {
-		message.data_size_ecss_ = total_eccs_size - ECSSSecondaryTMHeaderSize;
+	const uint16_t crcSize = CRCHelper::EnableCRC ? CRCField : 0U;
+	const uint16_t packetSize = CCSDSPrimaryHeaderSize + total_eccs_size + crcSize;
+	if (out.size() < packetSize) {
+		return etl::unexpected(OBDH_ERROR_MESSAGE_PARSER_COMPOSE_DATA_SIZE_LARGER_THAN_EXPECTED);
 	}
-	message.total_size_ccsds_ = total_eccs_size + CCSDSPrimaryHeaderSize;
 
-	// First, compose the ECSS part
-	// here the size must be totalECSSSize
-	auto result = composeECSS(message, total_eccs_size);
-
-	if (!result.has_value()) {
-		return etl::unexpected(result.error());
-	}
-	const auto& data = result.value();
+	message.total_size_ecss_ = total_eccs_size;
+	message.data_size_ecss_ = total_eccs_size - secondaryHeaderSize;
+	message.total_size_ccsds_ = total_eccs_size + CCSDSPrimaryHeaderSize;
 
 	// Parts of the header
 	ApplicationProcessId packetId = ((message.application_ID_ & 0x3U) << 9U) | (SpacecraftID & 0x1FFU);
@@ -312,30 +425,44 @@ etl::expected<String<CCSDSMaxMessageSize>, SpacecraftErrorCode> MessageParser::c
 
 
 	SequenceCount const packetSequenceControl = message.packet_sequence_count_ | (3U << 14U);
-	const uint16_t packetCCSDSDataLength = data.size() - 1;
-
-	// Compile the header
-	etl::array<uint8_t, CCSDSPrimaryHeaderSize> header = {};
+	const uint16_t packetCCSDSDataLength = total_eccs_size - 1;
+
+	uint8_t* const packet = out.data();
+	CRCHelper::Context crc;
+
+	// Primary (CCSDS) header
+	packet[0] = packetId >> 8U;
+	packet[1] = packetId & 0xffU;
+	packet[2] = packetSequenceControl >> 8U;
+	packet[3] = packetSequenceControl & 0xffU;
+	packet[4] = packetCCSDSDataLength >> 8U;
+	packet[5] = packetCCSDSDataLength & 0xffU;
+	uint16_t written = CCSDSPrimaryHeaderSize;
+
+	// Secondary (ECSS) header
+	written += writeECSSHeader(message, packet + written);
+	if constexpr (CRCHelper::EnableCRC) {
+		crc.update(packet, written);
+	}
 
-	header[0] = packetId >> 8U;
-	header[1] = packetId & 0xffU;
-	header[2] = packetSequenceControl >> 8U;
-	header[3] = packetSequenceControl & 0xffU;
-	header[4] = packetCCSDSDataLength >> 8U;
-	header[5] = packetCCSDSDataLength & 0xffU;
+	// User data field, padded with zeros up to the requested size
+	const uint16_t copySize = etl::min<uint16_t>(message.data_size_ecss_, ECSSMaxMessageSize);
+	etl::copy_n(message.data.begin(), copySize, packet + written);
+	etl::fill_n(packet + written + copySize, message.data_size_ecss_ - copySize, 0);
+	if constexpr (CRCHelper::EnableCRC) {
+		crc.update(packet + written, message.data_size_ecss_);
+	}
+	written += message.data_size_ecss_;
 
-	// Compile the final message by appending the header
-	String<CCSDSMaxMessageSize> ccsdsMessage(header.data(), CCSDSPrimaryHeaderSize);
-	ccsdsMessage.append(data);
 	// CRC
 	if constexpr (CRCHelper::EnableCRC) {
-		const CRCSize crcField = CRCHelper::calculateCRC(reinterpret_cast<uint8_t*>(ccsdsMessage.data()), CCSDSPrimaryHeaderSize + data.size());
-		etl::array<uint8_t, CRCField> crcMessage = {static_cast<uint8_t>(crcField >> 8U), static_cast<uint8_t>(crcField & 0xFF)};
-		String<CCSDSMaxMessageSize> crcString(crcMessage.data(), 2);
-		ccsdsMessage.append(crcString);
+		const CRCSize crcField = crc.finalize();
+		packet[written] = static_cast<uint8_t>(crcField >> 8U);
+		packet[written + 1] = static_cast<uint8_t>(crcField & 0xFF);
+		written += CRCField;
 	}
 
-	return ccsdsMessage;
+	return written;
 }
 
 SpacecraftErrorCode MessageParser::parseECSSTMHeader(const uint8_t* data, uint16_t length, Message& message) {
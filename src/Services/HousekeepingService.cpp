@@ -1,4 +1,5 @@
 #include "HousekeepingService.hpp"
+#include "IndexedMinHeap.hpp"
 #include "ServicePool.hpp"
 
 void parseHousekeepingStructureFromUint8Array(etl::span<uint8_t> array_input, HousekeepingStructure &structure_output) {
@@ -54,14 +55,149 @@ void parseUint8ArrayFromHousekeepingStructure(HousekeepingStructure structure_in
 	}
 }
 
-uint32_t _housekeeping_struct_timers[ECSSMaxHousekeepingStructures] = {0};
+/**
+ * The slots of the structures with periodic reporting enabled, keyed on the time their next report is due. Disabled
+ * structures are not in the heap at all.
+ */
+IndexedMinHeap<uint64_t, ECSSMaxHousekeepingStructures> _housekeeping_report_schedule;
+
+/**
+ * Milliseconds elapsed since the housekeeping timers were initialised, as reported to reportPendingStructuresMs()
+ */
+uint64_t _housekeeping_time_ms = 0;
+
+/**
+ * RAM mirror of the housekeeping structures stored in MRAM, one entry per slot
+ */
+etl::array<HousekeepingStructure, ECSSMaxHousekeepingStructures> _housekeeping_struct_cache;
+
+/**
+ * Structure ID -> lowest slot holding that ID, over the contents of _housekeeping_struct_cache
+ */
+etl::map<ParameterReportStructureId, uint8_t, ECSSMaxHousekeepingStructures> _housekeeping_struct_index;
+
+/**
+ * A housekeeping structure compiled into the steps needed to generate its TM[3,25] report. The type of each
+ * parameter is resolved when the structure changes, so that generating a report is a plain gather-and-append loop.
+ */
+struct HousekeepingReportPlan {
+	struct Entry {
+		ParameterId parameterId = 0;
+		uint8_t width = 0;
+		ParameterService::ParameterEncoder encoder = nullptr;
+	};
+
+	etl::vector<Entry, ECSSMaxSimplyCommutatedParameters> entries;
+
+	/**
+	 * The number of bytes appended by all the entries
+	 */
+	uint16_t valuesSize = 0;
+};
+
+/**
+ * The report plan of each slot of _housekeeping_struct_cache
+ */
+etl::array<HousekeepingReportPlan, ECSSMaxHousekeepingStructures> _housekeeping_report_plans;
+
+bool _housekeeping_struct_cache_loaded = false;
+
+/**
+ * Holds the lock of the state above, from \ref HousekeepingService::lockHousekeepingState, for as long as it exists.
+ * It is never held during an MRAM access or while a report is stored.
+ */
+class HousekeepingStateGuard {
+public:
+	HousekeepingStateGuard() {
+		HousekeepingService::lockHousekeepingState();
+	}
+
+	~HousekeepingStateGuard() {
+		HousekeepingService::unlockHousekeepingState();
+	}
+
+	HousekeepingStateGuard(const HousekeepingStateGuard&) = delete;
+	HousekeepingStateGuard& operator=(const HousekeepingStateGuard&) = delete;
+};
+
+/**
+ * Rebuilds the ID -> slot index after any slot has changed. Lower slots win, just like the linear search over MRAM
+ * that the index replaces. The caller holds a HousekeepingStateGuard, as for the other helpers below.
+ */
+void rebuildHousekeepingStructIndex() {
+	_housekeeping_struct_index.clear();
+	for (uint8_t i=0;i<ECSSMaxHousekeepingStructures;i++) {
+		_housekeeping_struct_index.insert({_housekeeping_struct_cache[i].structureId, i});
+	}
+}
 
-void HousekeepingService::initialiseHousekeepingTimers() {
-	for (int i=0;i<ECSSMaxHousekeepingStructures;i++) {
-		HousekeepingStructure housekeepingStructure = {};
-		readHousekeepingStruct(i, housekeepingStructure);
-		_housekeeping_struct_timers[i] = housekeepingStructure.collectionInterval;
+/**
+ * Compiles the report plan of a slot out of the parameters of its structure in _housekeeping_struct_cache
+ */
+void compileHousekeepingReportPlan(uint8_t slot) {
+	const HousekeepingStructure& structure = _housekeeping_struct_cache[slot];
+	HousekeepingReportPlan& plan = _housekeeping_report_plans[slot];
+	plan.entries.clear();
+	plan.valuesSize = 0;
+
+	const size_t parameterCount = etl::min<size_t>(structure.parameters_appended, structure.simplyCommutatedParameterIds.size());
+	for (size_t i=0;i<parameterCount;i++) {
+		const ParameterId parameterId = structure.simplyCommutatedParameterIds[i];
+		const ParameterService::ParameterEncoding encoding = ParameterService::getParameterEncoding(parameterId);
+		if (encoding.encoder == nullptr) {
+			continue;
+		}
+		plan.entries.push_back({parameterId, encoding.width, encoding.encoder});
+		plan.valuesSize += encoding.width;
+	}
+}
+
+/**
+ * Schedules the next report of a slot one collection interval from now, or removes it from the schedule if it is not
+ * periodically reported
+ */
+void scheduleHousekeepingStruct(uint8_t slot) {
+	const HousekeepingStructure& structure = _housekeeping_struct_cache[slot];
+	if (not structure.periodicGenerationActionStatus || structure.collectionInterval == 0) {
+		_housekeeping_report_schedule.remove(slot);
+		return;
+	}
+	const uint64_t interval = static_cast<uint64_t>(structure.collectionInterval) * ECSSHousekeepingMinimumSamplingIntervalMs;
+	_housekeeping_report_schedule.insertOrUpdate(slot, _housekeeping_time_ms + interval);
+}
+
+/**
+ * @return The slot holding the structure with ID \p structure_id, or -1 if there is none
+ */
+int findHousekeepingStructSlot(uint16_t structure_id) {
+	auto iterator = _housekeeping_struct_index.find(structure_id);
+	if (iterator == _housekeeping_struct_index.end()) {
+		return -1;
+	}
+	return iterator->second;
+}
+
+void HousekeepingService::loadHousekeepingStructCache() {
+	{
+		const HousekeepingStateGuard guard;
+		_housekeeping_report_schedule.clear();
 	}
+	for (uint8_t i=0;i<ECSSMaxHousekeepingStructures;i++) {
+		HousekeepingStructure structure;
+		readHousekeepingStruct(i, structure);
+
+		const HousekeepingStateGuard guard;
+		_housekeeping_struct_cache[i] = structure;
+		compileHousekeepingReportPlan(i);
+		scheduleHousekeepingStruct(i);
+	}
+	const HousekeepingStateGuard guard;
+	rebuildHousekeepingStructIndex();
+	_housekeeping_struct_cache_loaded = true;
+}
+
+void HousekeepingService::initialiseHousekeepingTimers() {
+	loadHousekeepingStructCache();
 }
 
 void HousekeepingService::readHousekeepingStruct(uint8_t struct_offset, HousekeepingStructure& structure) {
@@ -84,6 +220,11 @@ void HousekeepingService::readHousekeepingStruct(uint8_t struct_offset, Housekee
 }
 
 void HousekeepingService::updateHouseKeepingStruct(uint8_t struct_offset, HousekeepingStructure structure) {
+	if (not _housekeeping_struct_cache_loaded) {
+		loadHousekeepingStructCache();
+	}
+
+	// Write-through: MRAM is written first, so that the RAM mirror never holds a state that would be lost on a reset
 	etl::array<uint8_t, MemoryFilesystem::MRAM_DATA_BLOCK_SIZE-1> _write_arr = {0};
 	etl::span<uint8_t> _parse_span(_write_arr);
 	parseUint8ArrayFromHousekeepingStructure(structure, _parse_span);
@@ -93,17 +234,36 @@ void HousekeepingService::updateHouseKeepingStruct(uint8_t struct_offset, Housek
 		LOG_ERROR<<"[HOUSEKEEPING_STRUCT] Error saving housekeeping struct "<<struct_offset;
 		return;
 	}
+
+	{
+		const HousekeepingStateGuard guard;
+		// Only restart the collection timer if the timing of the structure has actually changed
+		const HousekeepingStructure& previous = _housekeeping_struct_cache[struct_offset];
+		const bool timingChanged = (previous.periodicGenerationActionStatus != structure.periodicGenerationActionStatus) ||
+		                           (previous.collectionInterval != structure.collectionInterval) ||
+		                           (previous.structureId != structure.structureId);
+
+		_housekeeping_struct_cache[struct_offset] = structure;
+		rebuildHousekeepingStructIndex();
+		compileHousekeepingReportPlan(struct_offset);
+		if (timingChanged) {
+			scheduleHousekeepingStruct(struct_offset);
+		}
+	}
 	LOG_INFO<<"[HOUSEKEEPING_STRUCT] Updated housekeeping struct "<<struct_offset;
 }
 
 int HousekeepingService::getHousekeepingStructureById(uint16_t structure_id, HousekeepingStructure& structure) {
-	for (int i=0;i<ECSSMaxHousekeepingStructures;i++) {
-		readHousekeepingStruct(i, structure);
-		if (structure.structureId == structure_id) {
-			return i;
-		}
+	if (not _housekeeping_struct_cache_loaded) {
+		loadHousekeepingStructCache();
+	}
+	const HousekeepingStateGuard guard;
+	const int slot = findHousekeepingStructSlot(structure_id);
+	if (slot < 0) {
+		return -1;
 	}
-	return -1;
+	structure = _housekeeping_struct_cache[slot];
+	return slot;
 }
 
 void HousekeepingService::createHousekeepingReportStructure(Message& request) {
@@ -217,19 +377,28 @@ bool HousekeepingService::housekeepingStructureReport(ParameterReportStructureId
 }
 
 void HousekeepingService::housekeepingParametersReport(ParameterReportStructureId structureId) {
-	HousekeepingStructure housekeepingStructure = {};
-	int offset = getHousekeepingStructureById(structureId, housekeepingStructure);
-	if (offset < 0) {
-		return;
+	if (not _housekeeping_struct_cache_loaded) {
+		loadHousekeepingStructCache();
+	}
+	// The plan is copied, so that the report is generated and stored without the lock
+	HousekeepingReportPlan plan;
+	{
+		const HousekeepingStateGuard guard;
+		const int offset = findHousekeepingStructSlot(structureId);
+		if (offset < 0) {
+			return;
+		}
+		plan = _housekeeping_report_plans[offset];
 	}
 
 	Message housekeepingReport = createTM(MessageType::HousekeepingParametersReport);
 
 	housekeepingReport.append<ParameterReportStructureId>(structureId);
-	auto structID = static_cast<HousekeepingStructId>(structureId);
-	for (size_t i=0;i<housekeepingStructure.parameters_appended;i++) {
-		auto paramId =housekeepingStructure.simplyCommutatedParameterIds[i];
-		Services.parameterManagement.appendParameterToMessage(housekeepingReport, housekeepingStructure.simplyCommutatedParameterIds[i]);
+	if (not ASSERT_INTERNAL(housekeepingReport.data_size_message_ + plan.valuesSize <= ECSSMaxMessageSize, ErrorHandler::MessageTooLarge)) {
+		return;
+	}
+	for (const auto& entry : plan.entries) {
+		entry.encoder(housekeepingReport, entry.parameterId);
 	}
 	storeMessage(housekeepingReport, housekeepingReport.data_size_message_);
 }
@@ -262,7 +431,7 @@ void HousekeepingService::appendParametersToHousekeepingStructure(Message& reque
 
 	for (uint16_t i = 0; i < numOfSimplyCommutatedParameters; i++) {
 		if (hasExceededMaxNumOfSimplyCommutatedParamsError(housekeepingStructure, request)) {
-			return;
+			break;
 		}
 		const ParameterId newParamId = request.read<ParameterId>();
 		if (!Services.parameterManagement.parameterExists(newParamId)) {
@@ -270,7 +439,9 @@ void HousekeepingService::appendParametersToHousekeepingStructure(Message& reque
 			continue;
 		}
 		housekeepingStructure.simplyCommutatedParameterIds.push_back(newParamId);
+		housekeepingStructure.parameters_appended++;
 	}
+	updateHouseKeepingStruct(offset, housekeepingStructure);
 }
 
 void HousekeepingService::modifyCollectionIntervalOfStructures(Message& request) {
@@ -361,25 +532,49 @@ void HousekeepingService::execute(Message& message) {
 }
 
 uint32_t HousekeepingService::reportPendingStructures(const uint32_t elapsed_time_s) {
-	uint32_t shortest_expiring_timer = 0xFFFFFFFF;
-	for (int i=0;i<ECSSMaxHousekeepingStructures;i++) {
-		if (_housekeeping_struct_timers[i]> elapsed_time_s) {
-			_housekeeping_struct_timers[i] -= elapsed_time_s;
-		}else {
-			HousekeepingStructure housekeepingStructure = {};
-			readHousekeepingStruct(i, housekeepingStructure);
-			if (!housekeepingStructure.periodicGenerationActionStatus) {
-				_housekeeping_struct_timers[i] = housekeepingStructure.collectionInterval;
-				continue;
+	const uint64_t nextReportMs = reportPendingStructuresMs(static_cast<uint64_t>(elapsed_time_s) * 1000U);
+	// Round up, so that the caller never wakes up before the next report is due
+	return static_cast<uint32_t>(etl::min<uint64_t>((nextReportMs + 999U) / 1000U, UINT32_MAX));
+}
+
+uint64_t HousekeepingService::reportPendingStructuresMs(const uint64_t elapsed_time_ms) {
+	{
+		const HousekeepingStateGuard guard;
+		_housekeeping_time_ms += elapsed_time_ms;
+	}
+
+	// Only the structures that are due are touched. Each one is rescheduled under the lock, and reported after it.
+	while (true) {
+		ParameterReportStructureId structureId = 0;
+		{
+			const HousekeepingStateGuard guard;
+			if (_housekeeping_report_schedule.empty() || (_housekeeping_report_schedule.topKey() > _housekeeping_time_ms)) {
+				break;
 			}
-			housekeepingParametersReport(housekeepingStructure.structureId);
-			_housekeeping_struct_timers[i] = housekeepingStructure.collectionInterval;
-		}
-		if (_housekeeping_struct_timers[i] < shortest_expiring_timer) {
-			shortest_expiring_timer = _housekeeping_struct_timers[i];
+			const uint8_t slot = _housekeeping_report_schedule.top();
+			const HousekeepingStructure& housekeepingStructure = _housekeeping_struct_cache[slot];
+			structureId = housekeepingStructure.structureId;
+
+			// Keep the phase of the collection interval, unless more than a whole interval has been missed
+			const uint64_t interval = static_cast<uint64_t>(housekeepingStructure.collectionInterval) * ECSSHousekeepingMinimumSamplingIntervalMs;
+			uint64_t nextReport = _housekeeping_report_schedule.topKey() + interval;
+			if (nextReport <= _housekeeping_time_ms) {
+				nextReport = _housekeeping_time_ms + interval;
+			}
+			_housekeeping_report_schedule.insertOrUpdate(slot, nextReport);
 		}
+		housekeepingParametersReport(structureId);
+	}
+
+	return getTimeUntilNextReportMs();
+}
+
+uint64_t HousekeepingService::getTimeUntilNextReportMs() {
+	const HousekeepingStateGuard guard;
+	if (_housekeeping_report_schedule.empty()) {
+		return ECSSHousekeepingMinimumSamplingIntervalMs;
 	}
-	return shortest_expiring_timer;
+	return _housekeeping_report_schedule.topKey() - _housekeeping_time_ms;
 }
 
 bool HousekeepingService::hasRequestedAppendToEnabledHousekeepingError(const HousekeepingStructure& housekeepingStruct, const Message& request) {
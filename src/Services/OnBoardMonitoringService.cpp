@@ -3,6 +3,19 @@
 #include "Message.hpp"
 #include "OnBoardMonitoringService.hpp"
 #include "ServicePool.hpp"
+#include "etl/algorithm.h"
+
+namespace {
+	/**
+	 * Forgets the samples of \p definition if it is a delta check, so that its deltas are not computed from samples
+	 * taken before it was enabled, disabled or modified
+	 */
+	void clearDeltaSamples(PMON& definition) {
+		if (definition.checkType == PMON::CheckType::Delta) {
+			static_cast<PMONDeltaCheck&>(definition).clearSamples();
+		}
+	}
+} // namespace
 
 void OnBoardMonitoringService::enableParameterMonitoringDefinitions(Message& message) {
 	if (!message.assertTC(ServiceType, EnableParameterMonitoringDefinitions)) {
@@ -20,6 +33,8 @@ void OnBoardMonitoringService::enableParameterMonitoringDefinitions(Message& mes
 		}
 		definition->second.get().repetitionNumber = 0;
 		definition->second.get().monitoringEnabled = true;
+		clearDeltaSamples(definition->second.get());
+		areMonitoringTablesOutdated = true;
 	}
 }
 
@@ -39,6 +54,9 @@ void OnBoardMonitoringService::disableParameterMonitoringDefinitions(Message& me
 		}
 		definition->second.get().monitoringEnabled = false;
 		definition->second.get().checkingStatus = PMON::Unchecked;
+		definition->second.get().checkTransitionList = {PMON::Unchecked, PMON::Unchecked};
+		clearDeltaSamples(definition->second.get());
+		areMonitoringTablesOutdated = true;
 	}
 }
 
@@ -59,7 +77,50 @@ void OnBoardMonitoringService::deleteAllParameterMonitoringDefinitions(const Mes
 		    ErrorHandler::ExecutionStartErrorType::InvalidRequestToDeleteAllParameterMonitoringDefinitions);
 		return;
 	}
+	clearParameterMonitoringList();
+}
+
+void OnBoardMonitoringService::clearParameterMonitoringList() {
+	for (auto& entry: parameterMonitoringList) {
+		releasePMONDefinition(entry.second.get());
+	}
 	parameterMonitoringList.clear();
+	areMonitoringTablesOutdated = true;
+}
+
+void OnBoardMonitoringService::releasePMONDefinition(PMON& definition) {
+	switch (definition.checkType) {
+		case PMON::CheckType::Limit:
+			limitChecks.destroy(&static_cast<PMONLimitCheck&>(definition));
+			break;
+		case PMON::CheckType::ExpectedValue:
+			expectedValueChecks.destroy(&static_cast<PMONExpectedValueCheck&>(definition));
+			break;
+		case PMON::CheckType::Delta:
+			deltaChecks.destroy(&static_cast<PMONDeltaCheck&>(definition));
+			break;
+	}
+}
+
+bool OnBoardMonitoringService::isMonitoringIntervalAvailable(PMONMonitoringInterval monitoringInterval) const {
+	if (monitoringInterval == 0) {
+		return false;
+	}
+
+	etl::vector<PMONMonitoringInterval, ECSSMaxMonitoringIntervals> intervalsInUse;
+	for (const auto& entry: parameterMonitoringList) {
+		const PMONMonitoringInterval intervalInUse = entry.second.get().monitoringInterval;
+		if (intervalInUse == monitoringInterval) {
+			return true;
+		}
+		if (etl::find(intervalsInUse.begin(), intervalsInUse.end(), intervalInUse) == intervalsInUse.end()) {
+			if (intervalsInUse.full()) {
+				return false;
+			}
+			intervalsInUse.push_back(intervalInUse);
+		}
+	}
+	return not intervalsInUse.full();
 }
 
 void OnBoardMonitoringService::addParameterMonitoringDefinitions(Message& message) {
@@ -70,10 +131,46 @@ void OnBoardMonitoringService::addParameterMonitoringDefinitions(Message& messag
 	for (uint16_t i = 0; i < numberOfIds; i++) {
 		ParameterId currentPMONId = message.read<ParameterId>();
 		ParameterId currentMonitoredParameterId = message.read<ParameterId>();
+		PMONMonitoringInterval currentMonitoringInterval = message.read<PMONMonitoringInterval>();
 		PMONRepetitionNumber currentPMONRepetitionNumber = message.read<PMONRepetitionNumber>();
 		uint16_t checkTypeValue = message.readEnum8();
 		auto currentCheckType = static_cast<PMON::CheckType>(checkTypeValue);
 
+		// The whole definition is read before it is checked, so that a rejected one leaves the next one in place
+		PMONLimit lowLimit = 0;
+		PMONLimit highLimit = 0;
+		DeltaThreshold lowDeltaThreshold = 0;
+		DeltaThreshold highDeltaThreshold = 0;
+		EventDefinitionId lowEventId = 0;
+		EventDefinitionId highEventId = 0;
+		PMONBitMask mask = 0;
+		PMONExpectedValue expectedValue = 0;
+		NumberOfConsecutiveDeltaChecks numberOfConsecutiveDeltaChecks = 0;
+		switch (currentCheckType) {
+			case PMON::CheckType::Limit:
+				lowLimit = message.read<PMONLimit>();
+				lowEventId = message.read<EventDefinitionId>();
+				highLimit = message.read<PMONLimit>();
+				highEventId = message.read<EventDefinitionId>();
+				break;
+			case PMON::CheckType::ExpectedValue:
+				mask = message.read<PMONBitMask>();
+				expectedValue = message.read<PMONExpectedValue>();
+				lowEventId = message.read<EventDefinitionId>();
+				break;
+			case PMON::CheckType::Delta:
+				lowDeltaThreshold = message.read<DeltaThreshold>();
+				lowEventId = message.read<EventDefinitionId>();
+				highDeltaThreshold = message.read<DeltaThreshold>();
+				highEventId = message.read<EventDefinitionId>();
+				numberOfConsecutiveDeltaChecks = message.read<NumberOfConsecutiveDeltaChecks>();
+				break;
+			default:
+				// The size of the definition is unknown, so the ones after it cannot be read either
+				ErrorHandler::reportInternalError(ErrorHandler::UnknownCheckType);
+				return;
+		}
+
 		if (!Services.parameterManagement.parameterExists(currentMonitoredParameterId)) {
 			ErrorHandler::reportError(message, ErrorHandler::ExecutionStartErrorType::GetNonExistingParameterMonitoringDefinition);
 			continue;
@@ -89,48 +186,61 @@ void OnBoardMonitoringService::addParameterMonitoringDefinitions(Message& messag
 			continue;
 		}
 
+		if (not isMonitoringIntervalAvailable(currentMonitoringInterval)) {
+			ErrorHandler::reportError(message, ErrorHandler::ExecutionStartErrorType::InvalidMonitoringInterval);
+			continue;
+		}
+
 		switch (currentCheckType) {
 			case PMON::CheckType::Limit: {
-				PMONLimit lowLimit = message.read<PMONLimit>();
-				EventDefinitionId belowLowLimitEventId = message.read<EventDefinitionId>();
-				PMONLimit highLimit = message.read<PMONLimit>();
-				EventDefinitionId aboveHighLimitEventId = message.read<EventDefinitionId>();
 				if (highLimit <= lowLimit) {
 					ErrorHandler::reportError(
 					    message, ErrorHandler::ExecutionStartErrorType::HighLimitIsLowerThanLowLimit);
 					continue;
 				}
+				if (limitChecks.full()) {
+					ErrorHandler::reportError(message, ErrorHandler::ExecutionStartErrorType::ParameterMonitoringListIsFull);
+					continue;
+				}
 				PMONLimitCheck limitCheck(currentMonitoredParameterId, currentPMONRepetitionNumber,
-				                          lowLimit, belowLowLimitEventId, highLimit, aboveHighLimitEventId);
+				                          lowLimit, lowEventId, highLimit, highEventId);
+				limitCheck.monitoringInterval = currentMonitoringInterval;
 				limitCheck.checkingStatus = PMON::Unchecked;
 				limitCheck.monitoringEnabled = false;
 				addPMONLimitCheck(currentPMONId, limitCheck);
 				break;
 			}
 			case PMON::CheckType::ExpectedValue: {
-				PMONBitMask mask = message.read<PMONBitMask>();
-				PMONExpectedValue expectedValue = message.read<PMONExpectedValue>();
-				EventDefinitionId unexpectedValueEvent = message.read<EventDefinitionId>();
+				if (expectedValueChecks.full()) {
+					ErrorHandler::reportError(message, ErrorHandler::ExecutionStartErrorType::ParameterMonitoringListIsFull);
+					continue;
+				}
 				PMONExpectedValueCheck expectedValueCheck(currentMonitoredParameterId, currentPMONRepetitionNumber,
-				                                          expectedValue, mask, unexpectedValueEvent);
+				                                          expectedValue, mask, lowEventId);
+				expectedValueCheck.monitoringInterval = currentMonitoringInterval;
 				expectedValueCheck.checkingStatus = PMON::Unchecked;
 				expectedValueCheck.monitoringEnabled = false;
 				addPMONExpectedValueCheck(currentPMONId, expectedValueCheck);
 				break;
 			}
 			case PMON::CheckType::Delta: {
-				DeltaThreshold lowDeltaThreshold = message.read<DeltaThreshold>();
-				EventDefinitionId belowLowThresholdEventId = message.read<EventDefinitionId>();
-				DeltaThreshold highDeltaThreshold = message.read<DeltaThreshold>();
-				EventDefinitionId aboveHighThresholdEventId = message.read<EventDefinitionId>();
-				NumberOfConsecutiveDeltaChecks numberOfConsecutiveDeltaChecks = message.read<NumberOfConsecutiveDeltaChecks>();
 				if (highDeltaThreshold <= lowDeltaThreshold) {
 					ErrorHandler::reportError(
 					    message, ErrorHandler::ExecutionStartErrorType::HighThresholdIsLowerThanLowThreshold);
 					continue;
 				}
+				if ((numberOfConsecutiveDeltaChecks == 0) or (numberOfConsecutiveDeltaChecks > ECSSMaxConsecutiveDeltaChecks)) {
+					ErrorHandler::reportError(
+					    message, ErrorHandler::ExecutionStartErrorType::InvalidNumberOfConsecutiveDeltaChecks);
+					continue;
+				}
+				if (deltaChecks.full()) {
+					ErrorHandler::reportError(message, ErrorHandler::ExecutionStartErrorType::ParameterMonitoringListIsFull);
+					continue;
+				}
 				PMONDeltaCheck deltaCheck(currentMonitoredParameterId, currentPMONRepetitionNumber,
-				                          numberOfConsecutiveDeltaChecks, lowDeltaThreshold, belowLowThresholdEventId, highDeltaThreshold, aboveHighThresholdEventId);
+				                          numberOfConsecutiveDeltaChecks, lowDeltaThreshold, lowEventId, highDeltaThreshold, highEventId);
+				deltaCheck.monitoringInterval = currentMonitoringInterval;
 				deltaCheck.checkingStatus = PMON::Unchecked;
 				deltaCheck.monitoringEnabled = false;
 				addPMONDeltaCheck(currentPMONId, deltaCheck);
@@ -151,12 +261,15 @@ void OnBoardMonitoringService::deleteParameterMonitoringDefinitions(Message& mes
 			continue;
 		}
 
-		if (getPMONDefinition(currentPMONId).get().monitoringEnabled) {
+		PMON& definition = getPMONDefinition(currentPMONId).get();
+		if (definition.monitoringEnabled) {
 			ErrorHandler::reportError(message, ErrorHandler::InvalidRequestToDeleteParameterMonitoringDefinition);
 			continue;
 		}
 
 		parameterMonitoringList.erase(currentPMONId);
+		releasePMONDefinition(definition);
+		areMonitoringTablesOutdated = true;
 	}
 }
 
@@ -186,6 +299,7 @@ void OnBoardMonitoringService::modifyParameterMonitoringDefinitions(Message& mes
 		}
 
 		PMON& pmon = it->second.get();
+		areMonitoringTablesOutdated = true;
 		pmon.repetitionCounter = 0;
 		pmon.repetitionNumber = currentPMONRepetitionNumber;
 		pmon.checkingStatus = PMON::Unchecked;
@@ -236,6 +350,11 @@ void OnBoardMonitoringService::modifyParameterMonitoringDefinitions(Message& mes
 					    message, ErrorHandler::ExecutionStartErrorType::HighThresholdIsLowerThanLowThreshold);
 					continue;
 				}
+				if ((numberOfConsecutiveDeltaChecks == 0) or (numberOfConsecutiveDeltaChecks > ECSSMaxConsecutiveDeltaChecks)) {
+					ErrorHandler::reportError(
+					    message, ErrorHandler::ExecutionStartErrorType::InvalidNumberOfConsecutiveDeltaChecks);
+					continue;
+				}
 
 				auto& deltaCheck = static_cast<PMONDeltaCheck&>(pmon);
 				deltaCheck.numberOfConsecutiveDeltaChecks = numberOfConsecutiveDeltaChecks;
@@ -243,6 +362,7 @@ void OnBoardMonitoringService::modifyParameterMonitoringDefinitions(Message& mes
 				deltaCheck.belowLowThresholdEvent = belowLowThresholdEventId;
 				deltaCheck.highDeltaThreshold = highDeltaThreshold;
 				deltaCheck.aboveHighThresholdEvent = aboveHighThresholdEventId;
+				deltaCheck.clearSamples();
 				break;
 			}
 		}
@@ -269,6 +389,7 @@ void OnBoardMonitoringService::reportParameterMonitoringDefinitions(Message& mes
 
 		pmonDefinitionReport.append<ParameterId>(currentPMONId);
 		pmonDefinitionReport.append<ParameterId>(pmon.monitoredParameterId);
+		pmonDefinitionReport.append<PMONMonitoringInterval>(pmon.monitoringInterval);
 		pmonDefinitionReport.appendBoolean(pmon.monitoringEnabled);
 		pmonDefinitionReport.append<PMONRepetitionNumber>(pmon.repetitionNumber);
 
@@ -308,12 +429,61 @@ void OnBoardMonitoringService::reportParameterMonitoringDefinitions(Message& mes
 	storeMessage(pmonDefinitionReport, pmonDefinitionReport.data_size_message_);
 }
 
-void OnBoardMonitoringService::checkAll() const {
-	for (const auto& entry: parameterMonitoringList) {
-		auto& pmon = entry.second.get();
-		if (pmon.isMonitoringEnabled()) {
-			pmon.performCheck();
+void OnBoardMonitoringService::checkAll() {
+	if (areMonitoringTablesOutdated) {
+		monitoringEngine.clear();
+		for (const auto& entry: parameterMonitoringList) {
+			auto& pmon = entry.second.get();
+			if (pmon.isMonitoringEnabled()) {
+				monitoringEngine.add(entry.first, pmon);
+			}
+		}
+		areMonitoringTablesOutdated = false;
+	}
+
+	monitoringEngine.checkAll();
+
+	if (checkTransitions.empty()) {
+		checkTransitionAge = 0;
+		return;
+	}
+	if ((checkTransitionAge >= maximumTransitionReportingDelay) or
+	    (checkTransitions.size() >= ECSSCheckTransitionsHighWaterMark)) {
+		checkTransitionReport();
+		checkTransitionAge = 0;
+	} else {
+		checkTransitionAge++;
+	}
+}
+
+void OnBoardMonitoringService::checkTransitionReport() {
+	CheckTransition transition;
+	uint16_t numberOfTransitions = etl::min(checkTransitions.size(), MaxTransitionsPerReport);
+
+	while (numberOfTransitions > 0) {
+		Message report(ServiceType, MessageType::CheckTransitionReport, Message::TM, ApplicationId);
+		report.appendUint16(numberOfTransitions);
+
+		for (uint16_t i = 0; i < numberOfTransitions; i++) {
+			checkTransitions.pop(transition);
+			report.append<ParameterId>(transition.pmonId);
+			report.append<ParameterId>(transition.monitoredParameterId);
+			report.append<PMON::CheckType>(transition.checkType);
+			if (transition.checkType == PMON::CheckType::ExpectedValue) {
+				report.append<PMONBitMask>(transition.mask);
+				report.append<uint64_t>(transition.unsignedValue);
+				report.append<PMONExpectedValue>(transition.expectedValue);
+			} else {
+				report.append<double>(transition.value);
+				report.append<double>(transition.limitCrossed);
+			}
+			report.append<PMON::CheckingStatus>(transition.previousStatus);
+			report.append<PMON::CheckingStatus>(transition.currentStatus);
+			report.append<Time::DefaultCUC>(transition.transitionTime);
 		}
+		storeMessage(report, report.data_size_message_);
+
+		numberOfTransitions = etl::min(checkTransitions.size(), MaxTransitionsPerReport);
 	}
 }
 
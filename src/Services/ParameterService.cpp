@@ -11,25 +11,42 @@ void ParameterService::reportParameters(Message& paramIds) {
 		return;
 	}
 	Message parameterReport = createTM(ParameterValuesReport);
-
-	uint16_t numOfIds = paramIds.readUint16();
+	// The number of parameters is not known in advance, so it is filled in before storing the report
+	parameterReport.appendUint16(0);
 	uint16_t numberOfValidIds = 0;
-	for (uint16_t i = 0; i < numOfIds; i++) {
-		if (parameterExists(paramIds.read<ParameterId>())) {
-			numberOfValidIds++;
-		}
-	}
-	parameterReport.appendUint16(numberOfValidIds);
-	paramIds.resetRead();
 
-	numOfIds = paramIds.readUint16();
+	const uint16_t numOfIds = paramIds.readUint16();
 	for (uint16_t i = 0; i < numOfIds; i++) {
 		const ParameterId currId = paramIds.read<ParameterId>();
+		if (!parameterExists(currId)) {
+			ErrorHandler::reportError(paramIds, ErrorHandler::ExecutionStartErrorType::GetNonExistingParameter);
+			continue;
+		}
+		const ParameterEncoding encoding = getParameterEncoding(currId);
+		if (encoding.encoder == nullptr) {
+			continue;
+		}
+
+		if ((parameterReport.data_size_message_ + sizeof(ParameterId) + encoding.width) > ECSSMaxMessageSize) {
+			// Split the rest of the parameters into a new report
+			storeParameterValuesReport(parameterReport, numberOfValidIds);
+			parameterReport = createTM(ParameterValuesReport);
+			parameterReport.appendUint16(0);
+			numberOfValidIds = 0;
+		}
+
 		parameterReport.append<ParameterId>(currId);
-		appendParameterToMessage(parameterReport, currId);
+		encoding.encoder(parameterReport, currId);
+		numberOfValidIds++;
 	}
 
-	storeMessage(parameterReport, parameterReport.data_size_message_);
+	storeParameterValuesReport(parameterReport, numberOfValidIds);
+}
+
+void ParameterService::storeParameterValuesReport(Message& report, uint16_t numberOfIds) {
+	report.data[0] = static_cast<uint8_t>(numberOfIds >> 8U);
+	report.data[1] = static_cast<uint8_t>(numberOfIds & 0xFFU);
+	storeMessage(report, report.data_size_message_);
 }
 
 void ParameterService::setParameters(Message& newParamValues) {
@@ -45,78 +62,45 @@ void ParameterService::setParameters(Message& newParamValues) {
 	}
 }
 
-void ParameterService::appendParameterToMessage(Message& message, ParameterId parameter) {
-	PARAMETER_TYPE type = getParameterType(parameter);
+ParameterService::ParameterEncoding ParameterService::getParameterEncoding(ParameterId parameter) {
+	PARAMETER_TYPE type = ParameterIndex::getParameterType(parameter);
 
 	switch (type) {
-		case PARAMETER_TYPE::UINT8: {
-			uint8_t temp = 0;
-			MemoryManager::getParameter(parameter, &temp);
-			message.append(temp);
-			break;
-		}
-		case PARAMETER_TYPE::INT8: {
-			int8_t temp = 0;
-			MemoryManager::getParameter(parameter, &temp);
-			message.append(temp);
-			break;
-		}
-		case PARAMETER_TYPE::UINT16: {
-			uint16_t temp = 0;
-			MemoryManager::getParameter(parameter, &temp);
-			message.append(temp);
-			break;
-		}
-		case PARAMETER_TYPE::INT16: {
-			int16_t temp = 0;
-			MemoryManager::getParameter(parameter, &temp);
-			message.append(temp);
-			break;
-		}
-		case PARAMETER_TYPE::UINT32: {
-			uint32_t temp = 0;
-			MemoryManager::getParameter(parameter, &temp);
-			message.append(temp);
-			break;
-		}
-		case PARAMETER_TYPE::INT32: {
-			int32_t temp = 0;
-			MemoryManager::getParameter(parameter, &temp);
-			message.append(temp);
-			break;
-		}
-		case PARAMETER_TYPE::FLOAT: {
-			float temp = 0;
-			MemoryManager::getParameter(parameter, &temp);
-			message.append(temp);
-			break;
-		}
-		case PARAMETER_TYPE::UINT64: {
-			uint64_t temp = 0;
-			MemoryManager::getParameter(parameter, &temp);
-			message.append(temp);
-			break;
-		}
-		case PARAMETER_TYPE::INT64: {
-			int64_t temp = 0;
-			MemoryManager::getParameter(parameter, &temp);
-			message.append(temp);
-			break;
-		}
-		case PARAMETER_TYPE::DOUBLE: {
-			double temp = 0;
-			MemoryManager::getParameter(parameter, &temp);
-			message.append(temp);
-			break;
-		}
+		case PARAMETER_TYPE::UINT8:
+			return {&appendTypedParameter<uint8_t>, sizeof(uint8_t)};
+		case PARAMETER_TYPE::INT8:
+			return {&appendTypedParameter<int8_t>, sizeof(int8_t)};
+		case PARAMETER_TYPE::UINT16:
+			return {&appendTypedParameter<uint16_t>, sizeof(uint16_t)};
+		case PARAMETER_TYPE::INT16:
+			return {&appendTypedParameter<int16_t>, sizeof(int16_t)};
+		case PARAMETER_TYPE::UINT32:
+			return {&appendTypedParameter<uint32_t>, sizeof(uint32_t)};
+		case PARAMETER_TYPE::INT32:
+			return {&appendTypedParameter<int32_t>, sizeof(int32_t)};
+		case PARAMETER_TYPE::FLOAT:
+			return {&appendTypedParameter<float>, sizeof(float)};
+		case PARAMETER_TYPE::UINT64:
+			return {&appendTypedParameter<uint64_t>, sizeof(uint64_t)};
+		case PARAMETER_TYPE::INT64:
+			return {&appendTypedParameter<int64_t>, sizeof(int64_t)};
+		case PARAMETER_TYPE::DOUBLE:
+			return {&appendTypedParameter<double>, sizeof(double)};
 		default:
 			// Handle unknown types safely
-			break;
+			return {};
+	}
+}
+
+void ParameterService::appendParameterToMessage(Message& message, ParameterId parameter) {
+	const ParameterEncoding encoding = getParameterEncoding(parameter);
+	if (encoding.encoder != nullptr) {
+		encoding.encoder(message, parameter);
 	}
 }
 
 void ParameterService::updateParameterFromMessage(Message& message, ParameterId parameter) {
-	PARAMETER_TYPE type = getParameterType(parameter);
+	PARAMETER_TYPE type = ParameterIndex::getParameterType(parameter);
 	const uint64_t temp_max = message.read<uint64_t>();
 
 	switch (type) {
@@ -6,77 +6,80 @@ String<ECSSPacketStoreIdSize> StorageAndRetrievalService::readPacketStoreId(Mess
 	return packetStoreId.data();
 }
 
-void StorageAndRetrievalService::deleteContentUntil(const String<ECSSPacketStoreIdSize>& packetStoreId,
-                                                    Time::DefaultCUC timeLimit) {
-	auto& telemetryPackets = packetStores[packetStoreId].storedTelemetryPackets;
-	while (not telemetryPackets.empty() and telemetryPackets.front().first <= timeLimit) {
-		telemetryPackets.pop_front();
+etl::optional<PacketStoreHandle> StorageAndRetrievalService::readPacketStoreHandle(Message& request) {
+	auto packetStore = findPacketStore(readPacketStoreId(request));
+	if (not packetStore) {
+		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
+	}
+	return packetStore;
+}
+
+void StorageAndRetrievalService::insertPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId,
+                                                   const PacketStore& packetStore) {
+	uint16_t handle = 0;
+	while ((handle < ECSSMaxPacketStores) and isHandleInUse[handle]) {
+		handle++;
 	}
+	if (not ASSERT_INTERNAL(handle < ECSSMaxPacketStores, ErrorHandler::InternalErrorType::MapFull)) {
+		return;
+	}
+	isHandleInUse[handle] = true;
+	packetStores[handle] = packetStore;
+	packetStoreHandles.insert({packetStoreId, static_cast<PacketStoreHandle>(handle)});
 }
 
 void StorageAndRetrievalService::copyFromTagToTag(Message& request) {
 	const Time::DefaultCUC startTime(request.read<Time::DefaultCUC>());
 	const Time::DefaultCUC endTime(request.read<Time::DefaultCUC>());
 
-	auto fromPacketStoreId = readPacketStoreId(request);
-	auto toPacketStoreId = readPacketStoreId(request);
+	auto fromPacketStoreHandle = findPacketStore(readPacketStoreId(request));
+	auto toPacketStoreHandle = findPacketStore(readPacketStoreId(request));
 
-	if (failedFromTagToTag(fromPacketStoreId, toPacketStoreId, startTime, endTime, request)) {
+	if (not checkPacketStores(fromPacketStoreHandle, toPacketStoreHandle, request) or
+	    failedFromTagToTag(*fromPacketStoreHandle, *toPacketStoreHandle, startTime, endTime, request)) {
 		return;
 	}
 
-	for (auto& packet: packetStores[fromPacketStoreId].storedTelemetryPackets) {
-		if (packet.first < startTime) {
-			continue;
-		}
-		if (packet.first > endTime) {
-			break;
-		}
-		packetStores[toPacketStoreId].storedTelemetryPackets.push_back(packet);
-	}
+	const auto& fromPacketStore = packetStores[*fromPacketStoreHandle];
+	fromPacketStore.copyPackets(fromPacketStore.lowerBound(startTime), fromPacketStore.upperBound(endTime),
+	                            packetStores[*toPacketStoreHandle]);
 }
 
 void StorageAndRetrievalService::copyAfterTimeTag(Message& request) {
 	const Time::DefaultCUC startTime(request.read<Time::DefaultCUC>());
 
-	auto fromPacketStoreId = readPacketStoreId(request);
-	auto toPacketStoreId = readPacketStoreId(request);
+	auto fromPacketStoreHandle = findPacketStore(readPacketStoreId(request));
+	auto toPacketStoreHandle = findPacketStore(readPacketStoreId(request));
 
-	if (failedAfterTimeTag(fromPacketStoreId, toPacketStoreId, startTime, request)) {
+	if (not checkPacketStores(fromPacketStoreHandle, toPacketStoreHandle, request) or
+	    failedAfterTimeTag(*fromPacketStoreHandle, *toPacketStoreHandle, startTime, request)) {
 		return;
 	}
 
-	for (auto& packet: packetStores[fromPacketStoreId].storedTelemetryPackets) {
-		if (packet.first < startTime) {
-			continue;
-		}
-		packetStores[toPacketStoreId].storedTelemetryPackets.push_back(packet);
-	}
+	const auto& fromPacketStore = packetStores[*fromPacketStoreHandle];
+	fromPacketStore.copyPackets(fromPacketStore.lowerBound(startTime), fromPacketStore.packetCount(),
+	                            packetStores[*toPacketStoreHandle]);
 }
 
 void StorageAndRetrievalService::copyBeforeTimeTag(Message& request) {
 	const Time::DefaultCUC endTime(request.read<Time::DefaultCUC>());
 
-	auto fromPacketStoreId = readPacketStoreId(request);
-	auto toPacketStoreId = readPacketStoreId(request);
+	auto fromPacketStoreHandle = findPacketStore(readPacketStoreId(request));
+	auto toPacketStoreHandle = findPacketStore(readPacketStoreId(request));
 
-	if (failedBeforeTimeTag(fromPacketStoreId, toPacketStoreId, endTime, request)) {
+	if (not checkPacketStores(fromPacketStoreHandle, toPacketStoreHandle, request) or
+	    failedBeforeTimeTag(*fromPacketStoreHandle, *toPacketStoreHandle, endTime, request)) {
 		return;
 	}
 
-	for (auto& packet: packetStores[fromPacketStoreId].storedTelemetryPackets) {
-		if (packet.first > endTime) {
-			break;
-		}
-		packetStores[toPacketStoreId].storedTelemetryPackets.push_back(packet);
-	}
+	const auto& fromPacketStore = packetStores[*fromPacketStoreHandle];
+	fromPacketStore.copyPackets(0, fromPacketStore.upperBound(endTime), packetStores[*toPacketStoreHandle]);
 }
 
-bool StorageAndRetrievalService::checkPacketStores(const String<ECSSPacketStoreIdSize>& fromPacketStoreId,
-                                                   const String<ECSSPacketStoreIdSize>& toPacketStoreId,
+bool StorageAndRetrievalService::checkPacketStores(const etl::optional<PacketStoreHandle>& fromPacketStore,
+                                                   const etl::optional<PacketStoreHandle>& toPacketStore,
                                                    const Message& request) {
-	if (packetStores.find(fromPacketStoreId) == packetStores.end() or
-	    packetStores.find(toPacketStoreId) == packetStores.end()) {
+	if (not fromPacketStore or not toPacketStore) {
 		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
 		return false;
 	}
@@ -91,98 +94,89 @@ bool StorageAndRetrievalService::checkTimeWindow(Time::DefaultCUC startTime, Tim
 	return false;
 }
 
-bool StorageAndRetrievalService::checkDestinationPacketStore(const String<ECSSPacketStoreIdSize>& toPacketStoreId,
-                                                             const Message& request) {
-	if (not packetStores[toPacketStoreId].storedTelemetryPackets.empty()) {
+bool StorageAndRetrievalService::checkDestinationPacketStore(PacketStoreHandle toPacketStore, const Message& request) {
+	if (not packetStores[toPacketStore].empty()) {
 		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::DestinationPacketStoreNotEmtpy);
 		return true;
 	}
 	return false;
 }
 
-bool StorageAndRetrievalService::noTimestampInTimeWindow(const String<ECSSPacketStoreIdSize>& fromPacketStoreId,
-                                                         Time::DefaultCUC startTime, Time::DefaultCUC endTime, const Message& request) {
-	if (endTime < packetStores[fromPacketStoreId].storedTelemetryPackets.front().first ||
-	    startTime > packetStores[fromPacketStoreId].storedTelemetryPackets.back().first) {
+bool StorageAndRetrievalService::noTimestampInTimeWindow(PacketStoreHandle fromPacketStore, Time::DefaultCUC startTime,
+                                                         Time::DefaultCUC endTime, const Message& request) {
+	const auto& packetStore = packetStores[fromPacketStore];
+	if (packetStore.lowerBound(startTime) >= packetStore.upperBound(endTime)) {
 		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::CopyOfPacketsFailed);
 		return true;
 	}
 	return false;
 }
 
-bool StorageAndRetrievalService::noTimestampInTimeWindow(const String<ECSSPacketStoreIdSize>& fromPacketStoreId,
-                                                         Time::DefaultCUC timeTag, const Message& request, bool isAfterTimeTag) {
+bool StorageAndRetrievalService::noTimestampInTimeWindow(PacketStoreHandle fromPacketStore, Time::DefaultCUC timeTag,
+                                                         const Message& request, bool isAfterTimeTag) {
+	const auto& packetStore = packetStores[fromPacketStore];
 	if (isAfterTimeTag) {
-		if (timeTag > packetStores[fromPacketStoreId].storedTelemetryPackets.back().first) {
+		if (packetStore.lowerBound(timeTag) == packetStore.packetCount()) {
 			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::CopyOfPacketsFailed);
 			return true;
 		}
-	} else if (timeTag < packetStores[fromPacketStoreId].storedTelemetryPackets.front().first) {
+	} else if (packetStore.upperBound(timeTag) == 0) {
 		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::CopyOfPacketsFailed);
 		return true;
 	}
 	return false;
 }
 
-bool StorageAndRetrievalService::failedFromTagToTag(const String<ECSSPacketStoreIdSize>& fromPacketStoreId,
-                                                    const String<ECSSPacketStoreIdSize>& toPacketStoreId,
+bool StorageAndRetrievalService::failedFromTagToTag(PacketStoreHandle fromPacketStore, PacketStoreHandle toPacketStore,
                                                     Time::DefaultCUC startTime, Time::DefaultCUC endTime, const Message& request) {
-	return (not checkPacketStores(fromPacketStoreId, toPacketStoreId, request) or
-	        checkTimeWindow(startTime, endTime, request) or checkDestinationPacketStore(toPacketStoreId, request) or
-	        noTimestampInTimeWindow(fromPacketStoreId, startTime, endTime, request));
+	return (checkTimeWindow(startTime, endTime, request) or checkDestinationPacketStore(toPacketStore, request) or
+	        noTimestampInTimeWindow(fromPacketStore, startTime, endTime, request));
 }
 
-bool StorageAndRetrievalService::failedAfterTimeTag(const String<ECSSPacketStoreIdSize>& fromPacketStoreId,
-                                                    const String<ECSSPacketStoreIdSize>& toPacketStoreId,
+bool StorageAndRetrievalService::failedAfterTimeTag(PacketStoreHandle fromPacketStore, PacketStoreHandle toPacketStore,
                                                     Time::DefaultCUC startTime, const Message& request) {
-	return (not checkPacketStores(fromPacketStoreId, toPacketStoreId, request) or
-	        checkDestinationPacketStore(toPacketStoreId, request) or
-	        noTimestampInTimeWindow(fromPacketStoreId, startTime, request, true));
+	return (checkDestinationPacketStore(toPacketStore, request) or
+	        noTimestampInTimeWindow(fromPacketStore, startTime, request, true));
 }
 
-bool StorageAndRetrievalService::failedBeforeTimeTag(const String<ECSSPacketStoreIdSize>& fromPacketStoreId,
-                                                     const String<ECSSPacketStoreIdSize>& toPacketStoreId,
+bool StorageAndRetrievalService::failedBeforeTimeTag(PacketStoreHandle fromPacketStore, PacketStoreHandle toPacketStore,
                                                      Time::DefaultCUC endTime, const Message& request) {
-	return (not checkPacketStores(fromPacketStoreId, toPacketStoreId, request) or
-	        checkDestinationPacketStore(toPacketStoreId, request) or
-	        noTimestampInTimeWindow(fromPacketStoreId, endTime, request, false));
+	return (checkDestinationPacketStore(toPacketStore, request) or
+	        noTimestampInTimeWindow(fromPacketStore, endTime, request, false));
 }
 
-void StorageAndRetrievalService::createContentSummary(Message& report,
-                                                      const String<ECSSPacketStoreIdSize>& packetStoreId) {
-	const Time::DefaultCUC oldestStoredPacketTime(packetStores[packetStoreId].storedTelemetryPackets.front().first);
+void StorageAndRetrievalService::createContentSummary(Message& report, const PacketStore& packetStore) {
+
+	const Time::DefaultCUC oldestStoredPacketTime(packetStore.timeTag(0));
 	report.append<Time::DefaultCUC>(oldestStoredPacketTime);
 
-	const Time::DefaultCUC newestStoredPacketTime(packetStores[packetStoreId].storedTelemetryPackets.back().first);
+	const Time::DefaultCUC newestStoredPacketTime(packetStore.timeTag(packetStore.packetCount() - 1));
 	report.append<Time::DefaultCUC>(newestStoredPacketTime);
 
-	report.append<Time::DefaultCUC>(packetStores[packetStoreId].openRetrievalStartTimeTag);
+	report.append<Time::DefaultCUC>(packetStore.openRetrievalStartTimeTag);
 
-	auto filledPercentage1 = static_cast<uint16_t>(static_cast<float>(packetStores[packetStoreId].storedTelemetryPackets.size()) * 100 / // NOLINT(cppcoreguidelines-avoid-magic-numbers)
-	                                               ECSSMaxPacketStoreSize);
+	auto filledPercentage1 = static_cast<uint16_t>(static_cast<float>(packetStore.calculateSizeInBytes()) * 100 / // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	                                               packetStore.capacityInBytes());
 	report.append<PercentageFilled>(filledPercentage1);
 
-	const uint16_t numOfPacketsToBeTransferred = std::count_if( // NOLINT(cppcoreguidelines-init-variables)
-	    std::begin(packetStores[packetStoreId].storedTelemetryPackets),
-	    std::end(packetStores[packetStoreId].storedTelemetryPackets), [this, &packetStoreId](auto packet) {
-		    return packet.first >= packetStores[packetStoreId].openRetrievalStartTimeTag;
-	    });
-	auto filledPercentage2 = static_cast<uint16_t>(static_cast<float>(numOfPacketsToBeTransferred) * 100 / ECSSMaxPacketStoreSize); // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+	const uint32_t bytesToBeTransferred =
+	    packetStore.calculateSizeInBytes(packetStore.lowerBound(packetStore.openRetrievalStartTimeTag), packetStore.packetCount());
+	auto filledPercentage2 = static_cast<uint16_t>(static_cast<float>(bytesToBeTransferred) * 100 / packetStore.capacityInBytes()); // NOLINT(cppcoreguidelines-avoid-magic-numbers)
 	report.append<PercentageFilled>(filledPercentage2);
 }
 
-bool StorageAndRetrievalService::failedStartOfByTimeRangeRetrieval(
-    const String<ECSSPacketStoreIdSize>& packetStoreId, Message& request) {
+bool StorageAndRetrievalService::failedStartOfByTimeRangeRetrieval(const etl::optional<PacketStoreHandle>& packetStore,
+                                                                   Message& request) {
 	bool errorFlag = false;
 
-	if (packetStores.find(packetStoreId) == packetStores.end()) {
+	if (not packetStore) {
 		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
 		errorFlag = true;
-	} else if (packetStores[packetStoreId].openRetrievalStatus == PacketStore::InProgress) {
+	} else if (packetStores[*packetStore].openRetrievalStatus == PacketStore::InProgress) {
 		ErrorHandler::reportError(request,
 		                          ErrorHandler::ExecutionStartErrorType::GetPacketStoreWithOpenRetrievalInProgress);
 		errorFlag = true;
-	} else if (packetStores[packetStoreId].byTimeRangeRetrievalStatus) {
+	} else if (packetStores[*packetStore].byTimeRangeRetrievalStatus) {
 		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::ByTimeRangeRetrievalAlreadyEnabled);
 		errorFlag = true;
 	}
@@ -196,52 +190,51 @@ bool StorageAndRetrievalService::failedStartOfByTimeRangeRetrieval(
 
 void StorageAndRetrievalService::addPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId,
                                                 const PacketStore& packetStore) {
-	packetStores.insert({packetStoreId, packetStore});
+	if (packetStoreHandles.find(packetStoreId) != packetStoreHandles.end()) {
+		return;
+	}
+	if (not ASSERT_INTERNAL(not packetStoreHandles.full(), ErrorHandler::InternalErrorType::MapFull)) {
+		return;
+	}
+	insertPacketStore(packetStoreId, packetStore);
 }
 
 void StorageAndRetrievalService::addTelemetryToPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId,
                                                            Time::DefaultCUC timestamp) {
-	Message tmPacket; // NOLINT(misc-const-correctness) as we might need to change
-	packetStores[packetStoreId].storedTelemetryPackets.push_back({timestamp, tmPacket});
+	addTelemetryToPacketStore(packetStoreId, timestamp, {});
+}
+
+bool StorageAndRetrievalService::addTelemetryToPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId,
+                                                           Time::DefaultCUC timestamp, etl::span<const uint8_t> packet) {
+	return getPacketStore(packetStoreId).storePacket(timestamp, packet);
 }
 
 void StorageAndRetrievalService::resetPacketStores() {
-	packetStores.clear();
+	packetStoreHandles.clear();
+	isHandleInUse.fill(false);
 }
 
 NumOfPacketStores StorageAndRetrievalService::currentNumberOfPacketStores() {
-	return packetStores.size();
+	return packetStoreHandles.size();
 }
 
 PacketStore& StorageAndRetrievalService::getPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId) {
-	auto packetStore = packetStores.find(packetStoreId);
-	ASSERT_INTERNAL(packetStore != packetStores.end(), ErrorHandler::InternalErrorType::ElementNotInArray);
-	return packetStore->second;
-}
-
-bool StorageAndRetrievalService::packetStoreExists(const String<ECSSPacketStoreIdSize>& packetStoreId) {
-	return packetStores.find(packetStoreId) != packetStores.end();
+	auto packetStore = packetStoreHandles.find(packetStoreId);
+	ASSERT_INTERNAL(packetStore != packetStoreHandles.end(), ErrorHandler::InternalErrorType::ElementNotInArray);
+	return packetStores[packetStore->second];
 }
 
-void StorageAndRetrievalService::executeOnPacketStores(Message& request,
-                                                       const std::function<void(PacketStore&)>& function) {
-	const NumOfPacketStores numOfPacketStores = request.readUint16();
-	if (numOfPacketStores == 0) {
-		for (auto& packetStore: packetStores) {
-			function(packetStore.second);
-		}
-		return;
+etl::optional<PacketStoreHandle>
+StorageAndRetrievalService::findPacketStore(const String<ECSSPacketStoreIdSize>& packetStoreId) const {
+	auto packetStore = packetStoreHandles.find(packetStoreId);
+	if (packetStore == packetStoreHandles.end()) {
+		return {};
 	}
+	return packetStore->second;
+}
 
-	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
-		auto packetStoreId = readPacketStoreId(request);
-		auto packetStore = packetStores.find(packetStoreId);
-		if (packetStore == packetStores.end()) {
-			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
-			continue;
-		}
-		function(packetStores[packetStoreId]);
-	}
+bool StorageAndRetrievalService::packetStoreExists(const String<ECSSPacketStoreIdSize>& packetStoreId) {
+	return packetStoreHandles.find(packetStoreId) != packetStoreHandles.end();
 }
 
 void StorageAndRetrievalService::enableStorageFunction(Message& request) {
@@ -249,7 +242,7 @@ void StorageAndRetrievalService::enableStorageFunction(Message& request) {
 		return;
 	}
 
-	executeOnPacketStores(request, [](PacketStore& p) { p.storageStatus = true; });
+	executeOnPacketStores(request, [](PacketStore& packetStore) { packetStore.storageStatus = true; });
 }
 
 void StorageAndRetrievalService::disableStorageFunction(Message& request) {
@@ -257,7 +250,7 @@ void StorageAndRetrievalService::disableStorageFunction(Message& request) {
 		return;
 	}
 
-	executeOnPacketStores(request, [](PacketStore& p) { p.storageStatus = false; });
+	executeOnPacketStores(request, [](PacketStore& packetStore) { packetStore.storageStatus = false; });
 }
 
 void StorageAndRetrievalService::startByTimeRangeRetrieval(Message& request) {
@@ -268,8 +261,8 @@ void StorageAndRetrievalService::startByTimeRangeRetrieval(Message& request) {
 	const NumOfPacketStores numOfPacketStores = request.readUint16();
 
 	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
-		auto packetStoreId = readPacketStoreId(request);
-		if (failedStartOfByTimeRangeRetrieval(packetStoreId, request)) {
+		auto packetStoreHandle = findPacketStore(readPacketStoreId(request));
+		if (failedStartOfByTimeRangeRetrieval(packetStoreHandle, request)) {
 			continue;
 		}
 		const Time::DefaultCUC retrievalStartTime(request.read<Time::DefaultCUC>());
@@ -282,11 +275,11 @@ void StorageAndRetrievalService::startByTimeRangeRetrieval(Message& request) {
 
 		// todo (#261): 6.15.3.5.2.d(4), actually count the current time
 
-		auto& packetStore = packetStores[packetStoreId];
+		auto& packetStore = packetStores[*packetStoreHandle];
 		packetStore.byTimeRangeRetrievalStatus = true;
 		packetStore.retrievalStartTime = retrievalStartTime;
 		packetStore.retrievalEndTime = retrievalEndTime;
-		// todo (#262): start the by-time-range retrieval process according to the priority policy
+		packetStore.rewindByTimeRangeRetrieval();
 	}
 }
 
@@ -296,42 +289,20 @@ void StorageAndRetrievalService::deletePacketStoreContent(Message& request) {
 	}
 
 	const Time::DefaultCUC timeLimit = request.read<Time::DefaultCUC>();
-	const NumOfPacketStores numOfPacketStores = request.readUint16();
 
-	if (numOfPacketStores == 0) {
-		for (const auto& packetStore: packetStores) {
-			if (packetStore.second.byTimeRangeRetrievalStatus) {
-				ErrorHandler::reportError(
-				    request, ErrorHandler::ExecutionStartErrorType::SetPacketStoreWithByTimeRangeRetrieval);
-				continue;
-			}
-			if (packetStore.second.openRetrievalStatus == PacketStore::InProgress) {
-				ErrorHandler::reportError(
-				    request, ErrorHandler::ExecutionStartErrorType::SetPacketStoreWithOpenRetrievalInProgress);
-				continue;
-			}
-			deleteContentUntil(packetStore.first, timeLimit);
-		}
-		return;
-	}
-	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
-		auto packetStoreId = readPacketStoreId(request);
-		if (packetStores.find(packetStoreId) == packetStores.end()) {
-			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
-			continue;
-		}
-		if (packetStores[packetStoreId].byTimeRangeRetrievalStatus) {
+	executeOnPacketStores(request, [&request, timeLimit](PacketStore& packetStore) {
+		if (packetStore.byTimeRangeRetrievalStatus) {
 			ErrorHandler::reportError(request,
 			                          ErrorHandler::ExecutionStartErrorType::SetPacketStoreWithByTimeRangeRetrieval);
-			continue;
+			return;
 		}
-		if (packetStores[packetStoreId].openRetrievalStatus == PacketStore::InProgress) {
+		if (packetStore.openRetrievalStatus == PacketStore::InProgress) {
 			ErrorHandler::reportError(request,
 			                          ErrorHandler::ExecutionStartErrorType::SetPacketStoreWithOpenRetrievalInProgress);
-			continue;
+			return;
 		}
-		deleteContentUntil(packetStoreId, timeLimit);
-	}
+		packetStore.removePacketsUntil(timeLimit);
+	});
 }
 
 void StorageAndRetrievalService::packetStoreContentSummaryReport(Message& request) {
@@ -343,19 +314,17 @@ void StorageAndRetrievalService::packetStoreContentSummaryReport(Message& reques
 	NumOfPacketStores numOfPacketStores = request.readUint16();
 
 	if (numOfPacketStores == 0) {
-		report.appendUint16(packetStores.size());
-		for (const auto& packetStore: packetStores) {
-			auto packetStoreId = packetStore.first;
-			report.appendString(packetStoreId);
-			createContentSummary(report, packetStoreId);
+		report.appendUint16(packetStoreHandles.size());
+		for (const auto& packetStore: packetStoreHandles) {
+			report.appendString(packetStore.first);
+			createContentSummary(report, packetStores[packetStore.second]);
 		}
 		storeMessage(report, report.data_size_message_);
 		return;
 	}
 	NumOfPacketStores numOfValidPacketStores = 0;
 	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
-		auto packetStoreId = readPacketStoreId(request);
-		if (packetStores.find(packetStoreId) != packetStores.end()) {
+		if (findPacketStore(readPacketStoreId(request))) {
 			numOfValidPacketStores++;
 		}
 	}
@@ -365,12 +334,13 @@ void StorageAndRetrievalService::packetStoreContentSummaryReport(Message& reques
 
 	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
 		auto packetStoreId = readPacketStoreId(request);
-		if (packetStores.find(packetStoreId) == packetStores.end()) {
+		auto packetStore = findPacketStore(packetStoreId);
+		if (not packetStore) {
 			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
 			continue;
 		}
 		report.appendString(packetStoreId);
-		createContentSummary(report, packetStoreId);
+		createContentSummary(report, packetStores[*packetStore]);
 	}
 	storeMessage(report, report.data_size_message_);
 }
@@ -384,32 +354,15 @@ void StorageAndRetrievalService::changeOpenRetrievalStartTimeTag(Message& reques
 	/**
 	 * @todo (#263): check if newStartTimeTag is in the future
 	 */
-	const NumOfPacketStores numOfPacketStores = request.readUint16();
-	if (numOfPacketStores == 0) {
-		for (auto& packetStore: packetStores) {
-			if (packetStore.second.openRetrievalStatus == PacketStore::InProgress) {
-				ErrorHandler::reportError(
-				    request, ErrorHandler::ExecutionStartErrorType::SetPacketStoreWithOpenRetrievalInProgress);
-				continue;
-			}
-			packetStore.second.openRetrievalStartTimeTag = newStartTimeTag;
-		}
-		return;
-	}
-
-	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
-		auto packetStoreId = readPacketStoreId(request);
-		if (packetStores.find(packetStoreId) == packetStores.end()) {
-			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
-			continue;
-		}
-		if (packetStores[packetStoreId].openRetrievalStatus == PacketStore::InProgress) {
+	executeOnPacketStores(request, [&request, newStartTimeTag](PacketStore& packetStore) {
+		if (packetStore.openRetrievalStatus == PacketStore::InProgress) {
 			ErrorHandler::reportError(request,
 			                          ErrorHandler::ExecutionStartErrorType::SetPacketStoreWithOpenRetrievalInProgress);
-			continue;
+			return;
 		}
-		packetStores[packetStoreId].openRetrievalStartTimeTag = newStartTimeTag;
-	}
+		packetStore.openRetrievalStartTimeTag = newStartTimeTag;
+		packetStore.rewindOpenRetrieval();
+	});
 }
 
 void StorageAndRetrievalService::resumeOpenRetrievalOfPacketStores(Message& request) {
@@ -417,32 +370,14 @@ void StorageAndRetrievalService::resumeOpenRetrievalOfPacketStores(Message& requ
 		return;
 	}
 
-	const NumOfPacketStores numOfPacketStores = request.readUint16();
-	if (numOfPacketStores == 0) {
-		for (auto& packetStore: packetStores) {
-			if (packetStore.second.byTimeRangeRetrievalStatus) {
-				ErrorHandler::reportError(
-				    request, ErrorHandler::ExecutionStartErrorType::SetPacketStoreWithByTimeRangeRetrieval);
-				continue;
-			}
-			packetStore.second.openRetrievalStatus = PacketStore::InProgress;
-		}
-		return;
-	}
-	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
-		auto packetStoreId = readPacketStoreId(request);
-		if (packetStores.find(packetStoreId) == packetStores.end()) {
-			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
-			continue;
-		}
-		auto& packetStore = packetStores[packetStoreId];
+	executeOnPacketStores(request, [&request](PacketStore& packetStore) {
 		if (packetStore.byTimeRangeRetrievalStatus) {
 			ErrorHandler::reportError(request,
 			                          ErrorHandler::ExecutionStartErrorType::SetPacketStoreWithByTimeRangeRetrieval);
-			continue;
+			return;
 		}
 		packetStore.openRetrievalStatus = PacketStore::InProgress;
-	}
+	});
 }
 
 void StorageAndRetrievalService::suspendOpenRetrievalOfPacketStores(Message& request) {
@@ -450,21 +385,7 @@ void StorageAndRetrievalService::suspendOpenRetrievalOfPacketStores(Message& req
 		return;
 	}
 
-	const NumOfPacketStores numOfPacketStores = request.readUint16();
-	if (numOfPacketStores == 0) {
-		for (auto& packetStore: packetStores) {
-			packetStore.second.openRetrievalStatus = PacketStore::Suspended;
-		}
-		return;
-	}
-	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
-		auto packetStoreId = readPacketStoreId(request);
-		if (packetStores.find(packetStoreId) == packetStores.end()) {
-			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
-			continue;
-		}
-		packetStores[packetStoreId].openRetrievalStatus = PacketStore::Suspended;
-	}
+	executeOnPacketStores(request, [](PacketStore& packetStore) { packetStore.openRetrievalStatus = PacketStore::Suspended; });
 }
 
 void StorageAndRetrievalService::abortByTimeRangeRetrieval(Message& request) {
@@ -472,21 +393,7 @@ void StorageAndRetrievalService::abortByTimeRangeRetrieval(Message& request) {
 		return;
 	}
 
-	const NumOfPacketStores numOfPacketStores = request.readUint16();
-	if (numOfPacketStores == 0) {
-		for (auto& packetStore: packetStores) {
-			packetStore.second.byTimeRangeRetrievalStatus = false;
-		}
-		return;
-	}
-	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
-		auto packetStoreId = readPacketStoreId(request);
-		if (packetStores.find(packetStoreId) == packetStores.end()) {
-			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
-			continue;
-		}
-		packetStores[packetStoreId].byTimeRangeRetrievalStatus = false;
-	}
+	executeOnPacketStores(request, [](PacketStore& packetStore) { packetStore.byTimeRangeRetrievalStatus = false; });
 }
 
 void StorageAndRetrievalService::packetStoresStatusReport(const Message& request) {
@@ -495,13 +402,13 @@ void StorageAndRetrievalService::packetStoresStatusReport(const Message& request
 	}
 
 	Message report = createTM(PacketStoresStatusReport);
-	report.appendUint16(packetStores.size());
-	for (const auto& packetStore: packetStores) {
-		auto packetStoreId = packetStore.first;
-		report.appendString(packetStoreId);
-		report.appendBoolean(packetStore.second.storageStatus);
-		report.appendEnum8(packetStore.second.openRetrievalStatus);
-		report.appendBoolean(packetStore.second.byTimeRangeRetrievalStatus);
+	report.appendUint16(packetStoreHandles.size());
+	for (const auto& packetStoreHandle: packetStoreHandles) {
+		const auto& packetStore = packetStores[packetStoreHandle.second];
+		report.appendString(packetStoreHandle.first);
+		report.appendBoolean(packetStore.storageStatus);
+		report.appendEnum8(packetStore.openRetrievalStatus);
+		report.appendBoolean(packetStore.byTimeRangeRetrievalStatus);
 	}
 	storeMessage(report, report.data_size_message_);
 }
@@ -513,13 +420,13 @@ void StorageAndRetrievalService::createPacketStores(Message& request) {
 
 	const NumOfPacketStores numOfPacketStores = request.readUint16();
 	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
-		if (packetStores.size() >= ECSSMaxPacketStores) {
+		if (packetStoreHandles.size() >= ECSSMaxPacketStores) {
 			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::MaxNumberOfPacketStoresReached);
 			return;
 		}
 		auto idToCreate = readPacketStoreId(request);
 
-		if (packetStores.find(idToCreate) != packetStores.end()) {
+		if (packetStoreHandles.find(idToCreate) != packetStoreHandles.end()) {
 			uint16_t const numberOfBytesToSkip = 4;
 			request.skipBytes(numberOfBytesToSkip);
 			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::AlreadyExistingPacketStore);
@@ -541,7 +448,7 @@ void StorageAndRetrievalService::createPacketStores(Message& request) {
 		newPacketStore.byTimeRangeRetrievalStatus = false;
 		newPacketStore.openRetrievalStatus = PacketStore::Suspended;
 		newPacketStore.virtualChannel = virtualChannel;
-		packetStores.insert({idToCreate, newPacketStore});
+		insertPacketStore(idToCreate, newPacketStore);
 	}
 }
 
@@ -552,44 +459,41 @@ void StorageAndRetrievalService::deletePacketStores(Message& request) {
 
 	const NumOfPacketStores numOfPacketStores = request.readUint16();
 	if (numOfPacketStores == 0) {
-		NumOfPacketStores numOfPacketStoresToDelete = 0; // NOLINT(misc-const-correctness)
-		etl::array<etl::string<ECSSPacketStoreIdSize>, ECSSMaxPacketStores> packetStoresToDelete = {};
-		for (const auto& packetStore: packetStores) {
-			if (packetStore.second.storageStatus) {
+		auto packetStoreHandle = packetStoreHandles.begin();
+		while (packetStoreHandle != packetStoreHandles.end()) {
+			const auto& packetStore = packetStores[packetStoreHandle->second];
+			if (packetStore.storageStatus) {
 				ErrorHandler::reportError(
 				    request, ErrorHandler::ExecutionStartErrorType::DeletionOfPacketStoreWithStorageStatusEnabled);
+				++packetStoreHandle;
 				continue;
 			}
-			if (packetStore.second.byTimeRangeRetrievalStatus) {
+			if (packetStore.byTimeRangeRetrievalStatus) {
 				ErrorHandler::reportError(
 				    request, ErrorHandler::ExecutionStartErrorType::DeletionOfPacketWithByTimeRangeRetrieval);
+				++packetStoreHandle;
 				continue;
 			}
-			if (packetStore.second.openRetrievalStatus == PacketStore::InProgress) {
+			if (packetStore.openRetrievalStatus == PacketStore::InProgress) {
 				ErrorHandler::reportError(
 				    request, ErrorHandler::ExecutionStartErrorType::DeletionOfPacketWithOpenRetrievalInProgress);
+				++packetStoreHandle;
 				continue;
 			}
-			packetStoresToDelete[numOfPacketStoresToDelete] = packetStore.first;
-			numOfPacketStoresToDelete++;
-		}
-		for (NumOfPacketStores l = 0; l < numOfPacketStoresToDelete; l++) {
-			etl::array<uint8_t, ECSSPacketStoreIdSize> data = {};
-			etl::string<ECSSPacketStoreIdSize> idToDelete = packetStoresToDelete[l];
-			std::copy(idToDelete.begin(), idToDelete.end(), data.data());
-			String<ECSSPacketStoreIdSize> const key(data.data());
-			packetStores.erase(key);
+			isHandleInUse[packetStoreHandle->second] = false;
+			packetStoreHandle = packetStoreHandles.erase(packetStoreHandle);
 		}
 		return;
 	}
 
 	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
 		auto idToDelete = readPacketStoreId(request);
-		if (packetStores.find(idToDelete) == packetStores.end()) {
+		auto packetStoreHandle = packetStoreHandles.find(idToDelete);
+		if (packetStoreHandle == packetStoreHandles.end()) {
 			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
 			continue;
 		}
-		const auto& packetStore = packetStores[idToDelete];
+		const auto& packetStore = packetStores[packetStoreHandle->second];
 
 		if (packetStore.storageStatus) {
 			ErrorHandler::reportError(
@@ -606,7 +510,8 @@ void StorageAndRetrievalService::deletePacketStores(Message& request) {
 			    request, ErrorHandler::ExecutionStartErrorType::DeletionOfPacketWithOpenRetrievalInProgress);
 			continue;
 		}
-		packetStores.erase(idToDelete);
+		isHandleInUse[packetStoreHandle->second] = false;
+		packetStoreHandles.erase(packetStoreHandle);
 	}
 }
 
@@ -616,14 +521,14 @@ void StorageAndRetrievalService::packetStoreConfigurationReport(const Message& r
 	}
 	Message report = createTM(PacketStoreConfigurationReport);
 
-	report.appendUint16(packetStores.size());
-	for (const auto& packetStore: packetStores) {
-		auto packetStoreId = packetStore.first;
-		report.appendString(packetStoreId);
-		report.appendUint16(packetStore.second.sizeInBytes);
-		const PacketStoreType typeCode = (packetStore.second.packetStoreType == PacketStore::Circular) ? 0 : 1;
+	report.appendUint16(packetStoreHandles.size());
+	for (const auto& packetStoreHandle: packetStoreHandles) {
+		const auto& packetStore = packetStores[packetStoreHandle.second];
+		report.appendString(packetStoreHandle.first);
+		report.appendUint16(packetStore.sizeInBytes);
+		const PacketStoreType typeCode = (packetStore.packetStoreType == PacketStore::Circular) ? 0 : 1;
 		report.append<PacketStoreType>(typeCode);
-		report.append<VirtualChannel>(packetStore.second.virtualChannel);
+		report.append<VirtualChannel>(packetStore.virtualChannel);
 	}
 	storeMessage(report, report.data_size_message_);
 }
@@ -657,13 +562,13 @@ void StorageAndRetrievalService::resizePacketStores(Message& request) {
 
 	const NumOfPacketStores numOfPacketStores = request.readUint16();
 	for (NumOfPacketStores i = 0; i < numOfPacketStores; i++) {
-		auto packetStoreId = readPacketStoreId(request);
+		auto packetStoreHandle = findPacketStore(readPacketStoreId(request));
 		const PacketStoreSize packetStoreSize = request.read<PacketStoreSize>(); // In bytes
-		if (packetStores.find(packetStoreId) == packetStores.end()) {
+		if (not packetStoreHandle) {
 			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
 			continue;
 		}
-		auto& packetStore = packetStores[packetStoreId];
+		auto& packetStore = packetStores[*packetStoreHandle];
 
 		if (packetStoreSize >= ECSSMaxPacketStoreSizeInBytes) {
 			ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::UnableToHandlePacketStoreSize);
@@ -693,12 +598,11 @@ void StorageAndRetrievalService::changeTypeToCircular(Message& request) {
 		return;
 	}
 
-	auto idToChange = readPacketStoreId(request);
-	if (packetStores.find(idToChange) == packetStores.end()) {
-		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
+	auto packetStoreHandle = readPacketStoreHandle(request);
+	if (not packetStoreHandle) {
 		return;
 	}
-	auto& packetStore = packetStores[idToChange];
+	auto& packetStore = packetStores[*packetStoreHandle];
 
 	if (packetStore.storageStatus) {
 		ErrorHandler::reportError(request,
@@ -723,12 +627,11 @@ void StorageAndRetrievalService::changeTypeToBounded(Message& request) {
 		return;
 	}
 
-	auto idToChange = readPacketStoreId(request);
-	if (packetStores.find(idToChange) == packetStores.end()) {
-		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
+	auto packetStoreHandle = readPacketStoreHandle(request);
+	if (not packetStoreHandle) {
 		return;
 	}
-	auto& packetStore = packetStores[idToChange];
+	auto& packetStore = packetStores[*packetStoreHandle];
 
 	if (packetStore.storageStatus) {
 		ErrorHandler::reportError(request,
@@ -753,13 +656,13 @@ void StorageAndRetrievalService::changeVirtualChannel(Message& request) {
 		return;
 	}
 
-	auto idToChange = readPacketStoreId(request);
+	auto packetStoreHandle = findPacketStore(readPacketStoreId(request));
 	const VirtualChannel virtualChannel = request.read<VirtualChannel>();
-	if (packetStores.find(idToChange) == packetStores.end()) {
+	if (not packetStoreHandle) {
 		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::NonExistingPacketStore);
 		return;
 	}
-	auto& packetStore = packetStores[idToChange];
+	auto& packetStore = packetStores[*packetStoreHandle];
 
 	if (virtualChannel < VirtualChannelLimits.min or virtualChannel > VirtualChannelLimits.max) {
 		ErrorHandler::reportError(request, ErrorHandler::ExecutionStartErrorType::InvalidVirtualChannel);
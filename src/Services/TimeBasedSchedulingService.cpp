@@ -9,62 +9,194 @@
 #include "TimeBasedSchedulingTask.hpp"
 
 
-SpacecraftErrorCode TimeBasedSchedulingService::readActivityEntries(ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities]) {
-	etl::array<uint8_t, activitiesEntriesArraySize> _activityEntriesBuffer = {0};
-	etl::span<uint8_t> _bufferSpan(_activityEntriesBuffer);
+namespace {
+	/**
+	 * Whether generation \p a is newer than generation \p b, also after the generation wraps around
+	 */
+	bool isNewerGeneration(uint16_t a, uint16_t b) {
+		return static_cast<int16_t>(static_cast<uint16_t>(a - b)) > 0;
+	}
+} // namespace
+
+bool TimeBasedSchedulingService::readSnapshotHeader(uint8_t slot, etl::array<uint8_t, MRAM_BLOCK_DATA_SIZE>& header, SpacecraftErrorCode& status) {
+	etl::span<uint8_t> _headerSpan(header);
 	uint16_t read_count = 0;
-	uint32_t _start_activity_block = 0;
-	uint32_t _end_activity_block = _start_activity_block + MRAM_BLOCKS_OFFSET_ACTIVITIES_LIST;
-	const auto status = MemoryManager::readFromFile(MemoryFilesystem::SCHED_TC_FILENAME, _bufferSpan, _start_activity_block, _end_activity_block, read_count);
 
-	if (status != Memory_Errno::NONE) {
-		return getSpacecraftErrorCodeFromMemoryError(status);
+	const uint32_t _block = slot * MRAM_BLOCKS_SNAPSHOT;
+	const auto memoryStatus = MemoryManager::readFromFile(MemoryFilesystem::SCHED_TC_FILENAME, _headerSpan, _block, _block + 1, read_count);
+	if (memoryStatus != Memory_Errno::NONE) {
+		status = getSpacecraftErrorCodeFromMemoryError(memoryStatus);
+		return false;
 	}
-	if (read_count!=activitiesEntriesArraySize) {
-		return getSpacecraftErrorCodeFromMemoryError(Memory_Errno::BAD_DATA);
+	if ((read_count < SNAPSHOT_HEADER_SIZE) || (header[0] != SCHEDULE_FORMAT_VERSION)) {
+		return false;
 	}
+	const uint16_t _check = (static_cast<uint16_t>(header[SNAPSHOT_HEADER_SIZE - 2]) << 8) | header[SNAPSHOT_HEADER_SIZE - 1];
+	return CRCHelper::calculateCRC(header.data(), SNAPSHOT_HEADER_SIZE - 2) == _check;
+}
 
-	uint8_t _activityEntriesIndex = 0;
-	for (int i = 0; i < ECSSMaxNumberOfTimeSchedActivities; ++i) {
-		ActivityEntry& entry = entries[i];
+bool TimeBasedSchedulingService::readSnapshotEntries(uint8_t slot, const etl::array<uint8_t, MRAM_BLOCK_DATA_SIZE>& header, SpacecraftErrorCode& status) {
+	etl::array<uint8_t, MRAM_BLOCK_DATA_SIZE> _blockBuffer = {0};
+	etl::span<uint8_t> _bufferSpan(_blockBuffer);
+	uint16_t read_count = 0;
+	CRCHelper::Context _entriesCRC;
+
+	for (uint32_t block = 1; block < MRAM_BLOCKS_SNAPSHOT; block++) {
+		const uint32_t _slot_block = (slot * MRAM_BLOCKS_SNAPSHOT) + block;
+		const auto memoryStatus = MemoryManager::readFromFile(MemoryFilesystem::SCHED_TC_FILENAME, _bufferSpan, _slot_block, _slot_block + 1, read_count);
+		if (memoryStatus != Memory_Errno::NONE) {
+			status = getSpacecraftErrorCodeFromMemoryError(memoryStatus);
+			return false;
+		}
 
-		entry.id = _activityEntriesBuffer[_activityEntriesIndex++];
-		entry.timestamp.year = static_cast<uint16_t>(_activityEntriesBuffer[_activityEntriesIndex++] << 8);
-		entry.timestamp.year |= static_cast<uint16_t>(_activityEntriesBuffer[_activityEntriesIndex++]);
-		entry.timestamp.month = _activityEntriesBuffer[_activityEntriesIndex++];
-		entry.timestamp.day = _activityEntriesBuffer[_activityEntriesIndex++];
-		entry.timestamp.hour = _activityEntriesBuffer[_activityEntriesIndex++];
-		entry.timestamp.minute = _activityEntriesBuffer[_activityEntriesIndex++];
-		entry.timestamp.second = _activityEntriesBuffer[_activityEntriesIndex++];
-		entry.state = static_cast<Activity_State>(_activityEntriesBuffer[_activityEntriesIndex++]);
+		const ActivityId _first_id = (block - 1) * SNAPSHOT_ENTRIES_PER_BLOCK;
+		const ActivityId _entries_in_block = etl::min<ActivityId>(SNAPSHOT_ENTRIES_PER_BLOCK, ECSSMaxNumberOfTimeSchedActivities - _first_id);
+		if (read_count < (_entries_in_block * SNAPSHOT_ENTRY_SIZE)) {
+			return false;
+		}
+		_entriesCRC.update(_blockBuffer.data(), _entries_in_block * SNAPSHOT_ENTRY_SIZE);
+
+		uint16_t _index = 0;
+		for (ActivityId id = _first_id; id < (_first_id + _entries_in_block); id++) {
+			ActivityEntry& entry = activityEntries[id];
+
+			entry.id = id;
+			entry.state = static_cast<Activity_State>(_blockBuffer[_index++]);
+			entry.timestamp.year = static_cast<uint16_t>(_blockBuffer[_index++] << 8);
+			entry.timestamp.year |= static_cast<uint16_t>(_blockBuffer[_index++]);
+			entry.timestamp.month = _blockBuffer[_index++];
+			entry.timestamp.day = _blockBuffer[_index++];
+			entry.timestamp.hour = _blockBuffer[_index++];
+			entry.timestamp.minute = _blockBuffer[_index++];
+			entry.timestamp.second = _blockBuffer[_index++];
+			entry.subScheduleId = _blockBuffer[_index++];
+			entry.groupId = _blockBuffer[_index++];
+
+			if ((entry.state != Activity_State::waiting) || (entry.subScheduleId >= ECSSMaxNumberOfTimeSchedSubSchedules) ||
+			    (entry.groupId >= ECSSMaxNumberOfTimeSchedGroups)) {
+				entry.state = Activity_State::invalid;
+			}
+		}
 	}
 
-	return SpacecraftErrorCode::GENERIC_ERROR_NONE;
+	uint16_t _index = SNAPSHOT_HEADER_SIZE - 4;
+	const uint16_t _check = (static_cast<uint16_t>(header[_index]) << 8) | header[_index + 1];
+	if (_entriesCRC.finalize() != _check) {
+		return false;
+	}
+
+	_index = 3;
+	for (uint8_t i = 0; i < ECSSMaxNumberOfTimeSchedSubSchedules; i++) {
+		enabledSubSchedules.set(i, ((header[_index + (i / 8)] >> (i % 8)) & 1U) != 0);
+	}
+	_index += (ECSSMaxNumberOfTimeSchedSubSchedules + 7) / 8;
+	for (uint8_t i = 0; i < ECSSMaxNumberOfTimeSchedGroups; i++) {
+		enabledGroups.set(i, ((header[_index + (i / 8)] >> (i % 8)) & 1U) != 0);
+	}
+	return true;
+}
+
+SpacecraftErrorCode TimeBasedSchedulingService::readScheduleSnapshot() {
+	etl::array<etl::array<uint8_t, MRAM_BLOCK_DATA_SIZE>, SNAPSHOT_SLOTS> _headers = {};
+	etl::array<bool, SNAPSHOT_SLOTS> _isHeaderValid = {};
+	SpacecraftErrorCode status = SpacecraftErrorCode::OBDH_ERROR_CORRUPTED_TC_SCHEDULE_FILE;
+
+	for (uint8_t slot = 0; slot < SNAPSHOT_SLOTS; slot++) {
+		_isHeaderValid[slot] = readSnapshotHeader(slot, _headers[slot], status);
+	}
+	isLatestSnapshotGenerationKnown = _isHeaderValid[0] || _isHeaderValid[1];
+	if (not isLatestSnapshotGenerationKnown) {
+		LOG_ERROR<<"[TC_SCHEDULING] No valid schedule snapshot";
+		return status;
+	}
+
+	uint8_t _newest_slot = _isHeaderValid[0] ? 0 : 1;
+	if (_isHeaderValid[0] && _isHeaderValid[1] &&
+	    isNewerGeneration(readSnapshotGeneration(_headers[1]), readSnapshotGeneration(_headers[0]))) {
+		_newest_slot = 1;
+	}
+	latestSnapshotGeneration = readSnapshotGeneration(_headers[_newest_slot]);
+
+	// The newest snapshot is tried first, the other one is only used if the entries of the newest one are damaged
+	for (uint8_t attempt = 0; attempt < SNAPSHOT_SLOTS; attempt++) {
+		const uint8_t slot = _newest_slot ^ attempt;
+		if (_isHeaderValid[slot] && readSnapshotEntries(slot, _headers[slot], status)) {
+			activeSnapshotSlot = slot;
+			journalGeneration = readSnapshotGeneration(_headers[slot]);
+			return SpacecraftErrorCode::GENERIC_ERROR_NONE;
+		}
+		LOG_ERROR<<"[TC_SCHEDULING] Unable to use schedule snapshot "<<static_cast<uint16_t>(slot);
+	}
+	return status;
 }
 
-SpacecraftErrorCode TimeBasedSchedulingService::storeActivityEntries(ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities]) {
-	etl::array<uint8_t, activitiesEntriesArraySize> _activityEntriesBuffer = {0};
-	uint8_t _activityEntriesIndex = 0;
-	for (int i=0;i<ECSSMaxNumberOfTimeSchedActivities;i++) {
-		_activityEntriesBuffer[_activityEntriesIndex++] = entries[i].id;
-		_activityEntriesBuffer[_activityEntriesIndex++] = static_cast<uint8_t>(entries[i].timestamp.year >> 8);	// MSB
-		_activityEntriesBuffer[_activityEntriesIndex++] = static_cast<uint8_t>(entries[i].timestamp.year & 0xFF);	// LSB
-		_activityEntriesBuffer[_activityEntriesIndex++] = entries[i].timestamp.month;
-		_activityEntriesBuffer[_activityEntriesIndex++] = entries[i].timestamp.day;
-		_activityEntriesBuffer[_activityEntriesIndex++] = entries[i].timestamp.hour;
-		_activityEntriesBuffer[_activityEntriesIndex++] = entries[i].timestamp.minute;
-		_activityEntriesBuffer[_activityEntriesIndex++] = entries[i].timestamp.second;
-		_activityEntriesBuffer[_activityEntriesIndex++] = static_cast<uint8_t>(entries[i].state);
-	}
-	etl::span<const uint8_t> _bufferSpan(_activityEntriesBuffer);
-	const auto status = MemoryManager::writeToMramFileAtOffset(MemoryFilesystem::SCHED_TC_FILENAME, _bufferSpan, 0);
+SpacecraftErrorCode TimeBasedSchedulingService::storeScheduleSnapshot(uint16_t generation) {
+	etl::array<uint8_t, MRAM_BLOCK_DATA_SIZE> _blockBuffer = {0};
+	uint16_t _index = 0;
+	CRCHelper::Context _entriesCRC;
+
+	const uint32_t _first_block = (activeSnapshotSlot ^ 1U) * MRAM_BLOCKS_SNAPSHOT;
+	for (uint32_t block = 1; block < MRAM_BLOCKS_SNAPSHOT; block++) {
+		const ActivityId _first_id = (block - 1) * SNAPSHOT_ENTRIES_PER_BLOCK;
+		const ActivityId _entries_in_block = etl::min<ActivityId>(SNAPSHOT_ENTRIES_PER_BLOCK, ECSSMaxNumberOfTimeSchedActivities - _first_id);
+
+		_index = 0;
+		for (ActivityId id = _first_id; id < (_first_id + _entries_in_block); id++) {
+			const ActivityEntry& entry = activityEntries[id];
+
+			_blockBuffer[_index++] = static_cast<uint8_t>(entry.state);
+			_blockBuffer[_index++] = static_cast<uint8_t>(entry.timestamp.year >> 8);	// MSB
+			_blockBuffer[_index++] = static_cast<uint8_t>(entry.timestamp.year & 0xFF);	// LSB
+			_blockBuffer[_index++] = entry.timestamp.month;
+			_blockBuffer[_index++] = entry.timestamp.day;
+			_blockBuffer[_index++] = entry.timestamp.hour;
+			_blockBuffer[_index++] = entry.timestamp.minute;
+			_blockBuffer[_index++] = entry.timestamp.second;
+			_blockBuffer[_index++] = entry.subScheduleId;
+			_blockBuffer[_index++] = entry.groupId;
+		}
+		_entriesCRC.update(_blockBuffer.data(), _index);
+
+		etl::span<const uint8_t> _entriesSpan(_blockBuffer.data(), _index);
+		const auto status = MemoryManager::writeToMramFileAtOffset(MemoryFilesystem::SCHED_TC_FILENAME, _entriesSpan, _first_block + block);
+		if (status != Memory_Errno::NONE) {
+			return getSpacecraftErrorCodeFromMemoryError(status);
+		}
+	}
+
+	_blockBuffer.fill(0);
+	_index = 0;
+	_blockBuffer[_index++] = SCHEDULE_FORMAT_VERSION;
+	_blockBuffer[_index++] = static_cast<uint8_t>(generation >> 8);	// MSB
+	_blockBuffer[_index++] = static_cast<uint8_t>(generation & 0xFF);	// LSB
+	for (uint8_t i = 0; i < ECSSMaxNumberOfTimeSchedSubSchedules; i++) {
+		if (enabledSubSchedules.test(i)) {
+			_blockBuffer[_index + (i / 8)] |= static_cast<uint8_t>(1U << (i % 8));
+		}
+	}
+	_index += (ECSSMaxNumberOfTimeSchedSubSchedules + 7) / 8;
+	for (uint8_t i = 0; i < ECSSMaxNumberOfTimeSchedGroups; i++) {
+		if (enabledGroups.test(i)) {
+			_blockBuffer[_index + (i / 8)] |= static_cast<uint8_t>(1U << (i % 8));
+		}
+	}
+	_index += (ECSSMaxNumberOfTimeSchedGroups + 7) / 8;
+	const uint16_t _entries_check = _entriesCRC.finalize();
+	_blockBuffer[_index++] = static_cast<uint8_t>(_entries_check >> 8);	// MSB
+	_blockBuffer[_index++] = static_cast<uint8_t>(_entries_check & 0xFF);	// LSB
+	const uint16_t _header_check = CRCHelper::calculateCRC(_blockBuffer.data(), _index);
+	_blockBuffer[_index++] = static_cast<uint8_t>(_header_check >> 8);	// MSB
+	_blockBuffer[_index++] = static_cast<uint8_t>(_header_check & 0xFF);	// LSB
+
+	etl::span<const uint8_t> _headerSpan(_blockBuffer.data(), SNAPSHOT_HEADER_SIZE);
+	const auto status = MemoryManager::writeToMramFileAtOffset(MemoryFilesystem::SCHED_TC_FILENAME, _headerSpan, _first_block);
 	if (status != Memory_Errno::NONE) {
 		return getSpacecraftErrorCodeFromMemoryError(status);
 	}
 	return SpacecraftErrorCode::GENERIC_ERROR_NONE;
 }
 
-SpacecraftErrorCode TimeBasedSchedulingService::storeScheduledActivity(ScheduledActivity activity, const uint8_t id) {
+SpacecraftErrorCode TimeBasedSchedulingService::storeScheduledActivity(ScheduledActivity activity, const ActivityId id) {
 	// Serialize entry to uint8_t buffer, to store it in memory
 	etl::array<uint8_t, MAX_ENTRY_SIZE> entryBuffer = {0};
 	uint16_t entryIndex = 0;
@@ -107,7 +239,7 @@ SpacecraftErrorCode TimeBasedSchedulingService::storeScheduledActivity(Scheduled
 	return SpacecraftErrorCode::GENERIC_ERROR_NONE;
 }
 
-SpacecraftErrorCode TimeBasedSchedulingService::recoverScheduledActivity(ScheduledActivity& activity, const uint8_t id) {
+SpacecraftErrorCode TimeBasedSchedulingService::recoverScheduledActivity(ScheduledActivity& activity, const ActivityId id) {
 	// Serial buffer, to read entry from memory
 	etl::array<uint8_t, MAX_ENTRY_SIZE> entryBuffer = {0};
 	etl::span<uint8_t> entryBufferSpan(entryBuffer);
@@ -149,7 +281,278 @@ TimeBasedSchedulingService::TimeBasedSchedulingService() {
 	serviceType = TimeBasedSchedulingService::ServiceType;
 }
 
-void TimeBasedSchedulingService::checkForPeriodicScheduledActivity(const uint8_t id) {
+SpacecraftErrorCode TimeBasedSchedulingService::loadActivityIndex() {
+	const auto status = readScheduleSnapshot();
+	if (status != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
+		return status;
+	}
+	replayActivityJournal();
+	rebuildActivityIndex();
+
+	activityIndexLoaded = true;
+	return SpacecraftErrorCode::GENERIC_ERROR_NONE;
+}
+
+void TimeBasedSchedulingService::rebuildActivityIndex() {
+	activityIndex.clear();
+	freeActivitySlotCount = 0;
+
+	// Pushed from the last slot, so that the lowest free slot is at the top until slots are freed again
+	for (ActivityId id = ECSSMaxNumberOfTimeSchedActivities; id > 0; id--) {
+		const ActivityEntry& entry = activityEntries[id - 1];
+		if (entry.state != Activity_State::waiting) {
+			freeActivitySlots[freeActivitySlotCount++] = entry.id;
+		} else if (isActivityReleasable(entry)) {
+			activityIndex.insertOrUpdate(entry.id, entry.timestamp);
+		}
+	}
+}
+
+void TimeBasedSchedulingService::replayActivityJournal() {
+	etl::array<uint8_t, MRAM_BLOCK_DATA_SIZE> _blockBuffer = {0};
+	etl::span<uint8_t> _bufferSpan(_blockBuffer);
+	uint16_t _read_count = 0;
+
+	journalRecordCount = 0;
+	journalBlock.fill(0);
+	for (uint32_t block = 0; block < MRAM_BLOCKS_JOURNAL; block++) {
+		const auto status = MemoryManager::readFromFile(MemoryFilesystem::SCHED_TC_FILENAME, _bufferSpan, MRAM_BLOCKS_OFFSET_JOURNAL + block, MRAM_BLOCKS_OFFSET_JOURNAL + block + 1, _read_count);
+		if (status != Memory_Errno::NONE) {
+			// The snapshot is still consistent on its own, new records will overwrite the rest of the journal
+			LOG_ERROR<<"[TC_SCHEDULING] Unable to read schedule journal";
+			break;
+		}
+
+		uint8_t _record_in_block = 0;
+		for (; _record_in_block < JOURNAL_RECORDS_PER_BLOCK; _record_in_block++) {
+			const uint16_t _position = _record_in_block * JOURNAL_RECORD_SIZE;
+			if ((_position + JOURNAL_RECORD_SIZE) > _read_count) {
+				break;
+			}
+			const uint8_t* record = &_blockBuffer[_position];
+
+			const auto type = static_cast<Journal_Record>(record[0]);
+			const ActivityId id = (static_cast<uint16_t>(record[1]) << 8) | record[2];
+			const uint8_t subScheduleId = record[10];
+			const uint8_t groupId = record[11];
+			const uint16_t generation = (static_cast<uint16_t>(record[12]) << 8) | record[13];
+			const auto check = static_cast<uint8_t>(CRCHelper::calculateCRC(record, JOURNAL_RECORD_SIZE - 1) & 0xFF);
+			if ((type == Journal_Record::empty) || (type > Journal_Record::invalidate) || (id >= ECSSMaxNumberOfTimeSchedActivities) ||
+			    (subScheduleId >= ECSSMaxNumberOfTimeSchedSubSchedules) || (groupId >= ECSSMaxNumberOfTimeSchedGroups) ||
+			    (generation != journalGeneration) || (check != record[JOURNAL_RECORD_SIZE - 1])) {
+				break;
+			}
+
+			ActivityEntry& entry = activityEntries[id];
+			if (type == Journal_Record::insert) {
+				entry.timestamp.year = (static_cast<uint16_t>(record[3]) << 8) | record[4];
+				entry.timestamp.month = record[5];
+				entry.timestamp.day = record[6];
+				entry.timestamp.hour = record[7];
+				entry.timestamp.minute = record[8];
+				entry.timestamp.second = record[9];
+				entry.subScheduleId = subScheduleId;
+				entry.groupId = groupId;
+				entry.state = Activity_State::waiting;
+			} else {
+				entry.state = Activity_State::invalid;
+			}
+			journalRecordCount++;
+		}
+
+		if (_record_in_block < JOURNAL_RECORDS_PER_BLOCK) {
+			// Keep the valid records of the last block, so that appending to it does not erase them
+			etl::copy_n(_blockBuffer.begin(), _record_in_block * JOURNAL_RECORD_SIZE, journalBlock.begin());
+			break;
+		}
+	}
+
+	if (journalRecordCount != 0) {
+		LOG_INFO<<"[TC_SCHEDULING] Replayed schedule journal records: "<<journalRecordCount;
+	}
+}
+
+SpacecraftErrorCode TimeBasedSchedulingService::appendJournalRecord(Journal_Record type, ActivityId id) {
+	if (journalRecordCount >= JOURNAL_CAPACITY) {
+		// Only after a failed compaction. The change is already in RAM, so it is part of the new snapshot.
+		return compactActivityJournal();
+	}
+
+	const uint32_t _block = journalRecordCount / JOURNAL_RECORDS_PER_BLOCK;
+	const uint16_t _position = (journalRecordCount % JOURNAL_RECORDS_PER_BLOCK) * JOURNAL_RECORD_SIZE;
+	if (_position == 0) {
+		journalBlock.fill(0);
+	}
+
+	const ActivityEntry& entry = activityEntries[id];
+	uint8_t* record = &journalBlock[_position];
+	record[0] = static_cast<uint8_t>(type);
+	record[1] = static_cast<uint8_t>(id >> 8);	// MSB
+	record[2] = static_cast<uint8_t>(id & 0xFF);	// LSB
+	record[3] = static_cast<uint8_t>(entry.timestamp.year >> 8);	// MSB
+	record[4] = static_cast<uint8_t>(entry.timestamp.year & 0xFF);	// LSB
+	record[5] = entry.timestamp.month;
+	record[6] = entry.timestamp.day;
+	record[7] = entry.timestamp.hour;
+	record[8] = entry.timestamp.minute;
+	record[9] = entry.timestamp.second;
+	record[10] = entry.subScheduleId;
+	record[11] = entry.groupId;
+	record[12] = static_cast<uint8_t>(journalGeneration >> 8);	// MSB
+	record[13] = static_cast<uint8_t>(journalGeneration & 0xFF);	// LSB
+	record[JOURNAL_RECORD_SIZE - 1] = static_cast<uint8_t>(CRCHelper::calculateCRC(record, JOURNAL_RECORD_SIZE - 1) & 0xFF);
+
+	// The records before this one are rewritten with the same contents, nothing after it is touched
+	etl::span<const uint8_t> _recordsSpan(journalBlock.data(), _position + JOURNAL_RECORD_SIZE);
+	const auto status = MemoryManager::writeToMramFileAtOffset(MemoryFilesystem::SCHED_TC_FILENAME, _recordsSpan, MRAM_BLOCKS_OFFSET_JOURNAL + _block);
+	if (status != Memory_Errno::NONE) {
+		LOG_ERROR<<"[TC_SCHEDULING] Error appending to schedule journal";
+		return compactActivityJournal();
+	}
+	journalRecordCount++;
+
+	if (journalRecordCount == JOURNAL_CAPACITY) {
+		// The change is already stored, a failed compaction is retried with the next one
+		compactActivityJournal();
+	}
+	return SpacecraftErrorCode::GENERIC_ERROR_NONE;
+}
+
+SpacecraftErrorCode TimeBasedSchedulingService::compactActivityJournal() {
+	// Newer than any generation in the journal, even if the newest snapshot could not be used
+	const uint16_t _new_generation = latestSnapshotGeneration + 1;
+	const auto status = storeScheduleSnapshot(_new_generation);
+	if (status != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
+		// The snapshot in use and its journal are untouched, keep appending to them
+		LOG_ERROR<<"[TC_SCHEDULING] Error compacting schedule journal";
+		return status;
+	}
+	activeSnapshotSlot ^= 1U;
+	journalGeneration = _new_generation;
+	latestSnapshotGeneration = _new_generation;
+	isLatestSnapshotGenerationKnown = true;
+	journalRecordCount = 0;
+	journalBlock.fill(0);
+	return SpacecraftErrorCode::GENERIC_ERROR_NONE;
+}
+
+SpacecraftErrorCode TimeBasedSchedulingService::resetActivityEntries() {
+	for (ActivityId id = 0; id < ECSSMaxNumberOfTimeSchedActivities; id++) {
+		activityEntries[id] = ActivityEntry{};
+		activityEntries[id].id = id;
+	}
+	enabledSubSchedules.set();
+	enabledGroups.set();
+	rebuildActivityIndex();
+	activityIndexLoaded = true;
+
+	if (not isLatestSnapshotGenerationKnown) {
+		// Nothing stored may outlive the reset, since the generation of the new snapshot could match old records.
+		// The headers go first, so that an interrupted reset leaves no valid snapshot at all.
+		const etl::array<uint8_t, MRAM_BLOCK_DATA_SIZE> _emptyBlock = {0};
+		etl::span<const uint8_t> _emptySpan(_emptyBlock);
+		for (uint8_t slot = 0; slot < SNAPSHOT_SLOTS; slot++) {
+			const auto status = MemoryManager::writeToMramFileAtOffset(MemoryFilesystem::SCHED_TC_FILENAME, _emptySpan, slot * MRAM_BLOCKS_SNAPSHOT);
+			if (status != Memory_Errno::NONE) {
+				return getSpacecraftErrorCodeFromMemoryError(status);
+			}
+		}
+		for (uint32_t block = 0; block < MRAM_BLOCKS_JOURNAL; block++) {
+			const auto status = MemoryManager::writeToMramFileAtOffset(MemoryFilesystem::SCHED_TC_FILENAME, _emptySpan, MRAM_BLOCKS_OFFSET_JOURNAL + block);
+			if (status != Memory_Errno::NONE) {
+				return getSpacecraftErrorCodeFromMemoryError(status);
+			}
+		}
+		latestSnapshotGeneration = 0;
+	}
+	// The empty snapshot replaces the schedule and its journal at once
+	return compactActivityJournal();
+}
+
+void TimeBasedSchedulingService::scheduleActivityEntry(ActivityId id, const UTCTimestamp& releaseTime) {
+	ActivityEntry& entry = activityEntries[id];
+	entry.state = Activity_State::waiting;
+	entry.timestamp = releaseTime;
+	if (isActivityReleasable(entry)) {
+		activityIndex.insertOrUpdate(id, releaseTime);
+	} else {
+		activityIndex.remove(id);
+	}
+}
+
+void TimeBasedSchedulingService::invalidateActivityEntry(ActivityId id) {
+	if (activityEntries[id].state == Activity_State::waiting) {
+		freeActivitySlots[freeActivitySlotCount++] = id;
+	}
+	activityEntries[id].state = Activity_State::invalid;
+	activityIndex.remove(id);
+}
+
+template <size_t Size>
+void TimeBasedSchedulingService::setEnabledIds(Message& request, etl::bitset<Size>& enabledIds, bool enable) {
+	if (not activityIndexLoaded && (loadActivityIndex() != SpacecraftErrorCode::GENERIC_ERROR_NONE)) {
+		// Reason for failure is printed inside the function
+		return;
+	}
+
+	const uint16_t numberOfIds = request.readUint16();
+	if (numberOfIds == 0) {
+		if (enable) {
+			enabledIds.set();
+		} else {
+			enabledIds.reset();
+		}
+	}
+	for (uint16_t i = 0; i < numberOfIds; i++) {
+		const uint8_t id = request.readUint8();
+		if (id >= Size) {
+			ErrorHandler::reportError(request, ErrorHandler::InstructionExecutionStartError);
+			continue;
+		}
+		enabledIds.set(id, enable);
+	}
+	rebuildActivityIndex();
+
+	// Enabling or disabling is rare, so it is stored in the snapshot header instead of the journal
+	const auto status = compactActivityJournal();
+	if (status != GENERIC_ERROR_NONE) {
+		Services.requestVerification.failCompletionExecutionVerification(request, status);
+		return;
+	}
+	Services.requestVerification.successCompletionExecutionVerification(request);
+
+	notifyNewActivityAddition();
+}
+
+void TimeBasedSchedulingService::enableSubSchedules(Message& request) {
+	if (!request.assertTC(ServiceType, MessageType::EnableTimeBasedSubSchedules)) {
+		return;
+	}
+	setEnabledIds(request, enabledSubSchedules, true);
+}
+
+void TimeBasedSchedulingService::disableSubSchedules(Message& request) {
+	if (!request.assertTC(ServiceType, MessageType::DisableTimeBasedSubSchedules)) {
+		return;
+	}
+	setEnabledIds(request, enabledSubSchedules, false);
+}
+
+void TimeBasedSchedulingService::enableGroups(Message& request) {
+	if (!request.assertTC(ServiceType, MessageType::EnableTimeBasedSchedulingGroups)) {
+		return;
+	}
+	setEnabledIds(request, enabledGroups, true);
+}
+
+void TimeBasedSchedulingService::disableGroups(Message& request) {
+	if (!request.assertTC(ServiceType, MessageType::DisableTimeBasedSchedulingGroups)) {
+		return;
+	}
+	setEnabledIds(request, enabledGroups, false);
+}
+
+void TimeBasedSchedulingService::checkForPeriodicScheduledActivity(const ActivityId id) {
 	ScheduledActivity _activity;
 	auto recoverStatus = recoverScheduledActivity(_activity, id);
 	if (recoverStatus != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
@@ -164,47 +567,30 @@ void TimeBasedSchedulingService::checkForPeriodicScheduledActivity(const uint8_t
 }
 
 UTCTimestamp TimeBasedSchedulingService::getNextScheduledActivityTimestamp(UTCTimestamp currentTime) {
-	ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities];
-	if (readActivityEntries(entries) != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
+	if (not activityIndexLoaded && (loadActivityIndex() != SpacecraftErrorCode::GENERIC_ERROR_NONE)) {
 		// Reason for failure is printed inside the function
 		return {9999, 12, 31, 23, 59, 59};
 	}
-	sortActivityEntries(entries);
-	auto storeStatus = storeActivityEntries(entries);
-	if (storeStatus != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
-		// Reason for failure is printed inside the function
-		return {9999, 12, 31, 23, 59, 59};
-	}
-	if (entries[0].state != Activity_State::invalid) {
-		if (currentTime > entries[0].timestamp) {
-			if (isExecutionTimeWithinMargin(currentTime, entries[0].timestamp)) {
-				return currentTime;
-			}
+
+	UTCTimestamp _next_release_time(9999, 12, 31, 23, 59, 59);
+	while (not activityIndex.empty()) {
+		const UTCTimestamp nextTimestamp = activityIndex.topKey();
+		if (not(nextTimestamp < currentTime)) {
+			_next_release_time = nextTimestamp;
+			break;
 		}
-		if ( entries[0].timestamp < currentTime) {
-			LOG_INFO<<"[TC_SCHEDULING] Maybe a time shift happened?";
-			uint8_t _stored_tc_to_check = 0;
-			while ((not isExecutionTimeWithinMargin(currentTime, entries[_stored_tc_to_check].timestamp))  && (entries[_stored_tc_to_check].state == Activity_State::waiting)) {
-				// Expired TC
-				LOG_DEBUG<<"[TC_SCHEDULING] Found expired TC, invalidating";
-				entries[_stored_tc_to_check].state = Activity_State::invalid;
-				checkForPeriodicScheduledActivity(_stored_tc_to_check);
-				_stored_tc_to_check++;
-				if (_stored_tc_to_check == ECSSMaxNumberOfTimeSchedActivities) {
-					storeActivityEntries(entries);
-					return {9999, 12, 31, 23, 59, 59};
-				}
-			}
-			storeActivityEntries(entries);
-			if (entries[_stored_tc_to_check].state == Activity_State::waiting) {
-				return entries[_stored_tc_to_check].timestamp;
-			}
-			return {9999, 12, 31, 23, 59, 59};
+		if (isExecutionTimeWithinMargin(currentTime, nextTimestamp)) {
+			_next_release_time = currentTime;
+			break;
 		}
-
-		return entries[0].timestamp;
+		// Expired TC, maybe a time shift happened?
+		const ActivityId _expired_id = activityIndex.top();
+		LOG_DEBUG<<"[TC_SCHEDULING] Found expired TC, invalidating";
+		invalidateActivityEntry(_expired_id);
+		appendJournalRecord(Journal_Record::invalidate, _expired_id);
+		checkForPeriodicScheduledActivity(_expired_id);
 	}
-	return {9999, 12, 31, 23, 59, 59};
+	return _next_release_time;
 }
 
 bool TimeBasedSchedulingService::hasActivityExpired(UTCTimestamp currentTime, UTCTimestamp executionTime) const {
@@ -230,30 +616,31 @@ bool TimeBasedSchedulingService::isExecutionTimeWithinMargin(UTCTimestamp curren
 }
 
 void TimeBasedSchedulingService::executeScheduledActivity(UTCTimestamp currentTime) {
-	ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities];
-	if (readActivityEntries(entries) != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
+	if (not activityIndexLoaded && (loadActivityIndex() != SpacecraftErrorCode::GENERIC_ERROR_NONE)) {
 		// Reason for failure is printed inside the function
 		return;
 	}
 
-	uint8_t _stored_tc_to_check = 0;
-	while ((hasActivityExpired(currentTime, entries[_stored_tc_to_check].timestamp))  && (entries[_stored_tc_to_check].state == Activity_State::waiting)) {
-		// Expired TC
-		LOG_DEBUG<<"[TC_SCHEDULING] Found expired TC, invalidating";
-		entries[_stored_tc_to_check].state = Activity_State::invalid;
-		_stored_tc_to_check++;
-		checkForPeriodicScheduledActivity(_stored_tc_to_check);
-		if (_stored_tc_to_check == ECSSMaxNumberOfTimeSchedActivities) {
-			_stored_tc_to_check=0;
+	while (not activityIndex.empty()) {
+		const ActivityId _next_id = activityIndex.top();
+		const UTCTimestamp nextTimestamp = activityIndex.topKey();
+
+		if (hasActivityExpired(currentTime, nextTimestamp)) {
+			// Expired TC
+			LOG_DEBUG<<"[TC_SCHEDULING] Found expired TC, invalidating";
+			invalidateActivityEntry(_next_id);
+			appendJournalRecord(Journal_Record::invalidate, _next_id);
+			checkForPeriodicScheduledActivity(_next_id);
+			continue;
+		}
+		if (not isExecutionTimeWithinMargin(currentTime, nextTimestamp)) {
 			break;
 		}
-	}
 
-	while (isExecutionTimeWithinMargin(currentTime, entries[_stored_tc_to_check].timestamp) && (entries[_stored_tc_to_check].state == Activity_State::waiting) ) {
 		ScheduledActivity _activity;
-		auto recoverStatus = recoverScheduledActivity(_activity, entries[_stored_tc_to_check].id);
+		auto recoverStatus = recoverScheduledActivity(_activity, _next_id);
 		if (recoverStatus != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
-			return;
+			break;
 		}
 		if (_activity.requestID.applicationID == ApplicationId) {
 			auto status = tcHandlingTask->addToQueue(_activity.request, 20);
@@ -264,11 +651,9 @@ void TimeBasedSchedulingService::executeScheduledActivity(UTCTimestamp currentTi
 				LOG_ERROR<<"[TC_SCHEDULING] Failed to add activity to TC Handling queue";
 			}
 		}
-		entries[_stored_tc_to_check].state = Activity_State::invalid;
-		_stored_tc_to_check++;
+		invalidateActivityEntry(_next_id);
+		appendJournalRecord(Journal_Record::execute, _next_id);
 	}
-	sortActivityEntries(entries);
-	storeActivityEntries(entries);
 }
 
 void TimeBasedSchedulingService::enableScheduleExecution(const Message& request) {
@@ -299,12 +684,7 @@ void TimeBasedSchedulingService::resetSchedule(const Message& request) {
 	}
 	uint8_t _valid_tc_schedule = 0;
 
-	ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities] = {0};
-	for (int i=0; i<ECSSMaxNumberOfTimeSchedActivities;i++) {
-		entries[i].id = i;
-		entries[i].state = Activity_State::invalid;
-	}
-	const auto deleteStatus = storeActivityEntries(entries);
+	const auto deleteStatus = resetActivityEntries();
 
 	if (deleteStatus != GENERIC_ERROR_NONE) {
 		LOG_ERROR<<"[TC_SCHEDULING] Error reseting schedule <SEC>"<<static_cast<uint16_t>(deleteStatus);
@@ -327,67 +707,79 @@ void TimeBasedSchedulingService::insertActivities(Message& request) {
 		return;
 	}
 
-	ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities];
-	if (readActivityEntries(entries) != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
+	if (not activityIndexLoaded && (loadActivityIndex() != SpacecraftErrorCode::GENERIC_ERROR_NONE)) {
 		// Reason for failure is printed inside the function
 		return;
 	}
 
+	SpacecraftErrorCode status = SpacecraftErrorCode::GENERIC_ERROR_NONE;
 	uint16_t iterationCount = request.readUint16();
 	const UTCTimestamp currentTime(TimeGetter::getCurrentTimeUTC());
 	const UTCTimestamp releaseTime(request.readUTCTimestamp());
 	while (iterationCount != 0) {
+		iterationCount-=1;
 
+		uint8_t subScheduleId = 0;
+		uint8_t groupId = 0;
+#if SUB_SCHEDULES_ENABLED
+		subScheduleId = request.readUint8();
+#endif
+#if GROUPS_ENABLED
+		groupId = request.readUint8();
+#endif
+		etl::array<uint8_t, ECSSTCRequestStringSize> requestData = {0};
+		request.readString(requestData.data(), ECSSTCRequestStringSize);
 
 		if ((releaseTime < (currentTime + ECSSTimeMarginForActivation))) {
 			LOG_ERROR<<"[TC_SCHEDULING] Rejected scheduled TC due to short release time";
 			ErrorHandler::reportError(request, ErrorHandler::InstructionExecutionStartError);
-			// request.skipBytes(ECSSTCRequestStringSize);
-		} else {
-			uint8_t _available_id = 255;
-			for (int i=0; i<ECSSMaxNumberOfTimeSchedActivities; i++){
-				if (entries[i].state != Activity_State::waiting) {
-					_available_id = entries[i].id;
-					entries[i].state = Activity_State::waiting;
-					entries[i].timestamp = releaseTime;
-					break;
-				}
-			}
-			if (_available_id == 255) {
-				LOG_ERROR<<"[TC_SCHEDULING] Rejected scheduled TC, list full";
-				ErrorHandler::reportError(request, ErrorHandler::InstructionExecutionStartError);
-				return;
-			}
-			etl::array<uint8_t, ECSSTCRequestStringSize> requestData = {0};
-			request.readString(requestData.data(), ECSSTCRequestStringSize);
-			Message receivedTCPacket;
-			receivedTCPacket.total_size_ecss_ = request.data_size_ecss_ + ECSSSecondaryTCHeaderSize;
-			receivedTCPacket.packet_type_ = Message::TC;
-			receivedTCPacket.data_size_message_ = request.data_size_message_;
-			const auto res = MessageParser::parseECSSTC(requestData.data(), receivedTCPacket);
-			if (res != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
-				LOG_ERROR<<"[TC_SCHEDULING] Error parsing TC <SEC>: "<<res;
-				continue;
-			}
-			ScheduledActivity newActivity;
+			continue;
+		}
+		if ((subScheduleId >= ECSSMaxNumberOfTimeSchedSubSchedules) || (groupId >= ECSSMaxNumberOfTimeSchedGroups)) {
+			LOG_ERROR<<"[TC_SCHEDULING] Rejected scheduled TC, unknown sub-schedule or group";
+			ErrorHandler::reportError(request, ErrorHandler::InstructionExecutionStartError);
+			continue;
+		}
+		if (freeActivitySlotCount == 0) {
+			LOG_ERROR<<"[TC_SCHEDULING] Rejected scheduled TC, list full";
+			ErrorHandler::reportError(request, ErrorHandler::InstructionExecutionStartError);
+			return;
+		}
+		// The slot is only taken once the activity is stored
+		const ActivityId _available_id = freeActivitySlots[freeActivitySlotCount - 1];
+
+		Message receivedTCPacket;
+		receivedTCPacket.total_size_ecss_ = request.data_size_ecss_ + ECSSSecondaryTCHeaderSize;
+		receivedTCPacket.packet_type_ = Message::TC;
+		receivedTCPacket.data_size_message_ = request.data_size_message_;
+		const auto res = MessageParser::parseECSSTC(requestData.data(), receivedTCPacket);
+		if (res != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
+			LOG_ERROR<<"[TC_SCHEDULING] Error parsing TC <SEC>: "<<res;
+			continue;
+		}
+		ScheduledActivity newActivity;
 
-			newActivity.request = receivedTCPacket;
-			newActivity.requestReleaseTime = releaseTime;
+		newActivity.request = receivedTCPacket;
+		newActivity.requestReleaseTime = releaseTime;
 
-			newActivity.requestID.sourceID = request.source_ID_;
-			newActivity.requestID.applicationID = request.application_ID_;
-			newActivity.requestID.sequenceCount = request.packet_sequence_count_;
+		newActivity.requestID.sourceID = request.source_ID_;
+		newActivity.requestID.applicationID = request.application_ID_;
+		newActivity.requestID.sequenceCount = request.packet_sequence_count_;
 
-			auto storeStatus = storeScheduledActivity(newActivity, _available_id);
-			if (storeStatus != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
-				// Reason for failure is printed inside the function
-				return;
-			}
+		auto storeStatus = storeScheduledActivity(newActivity, _available_id);
+		if (storeStatus != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
+			// Reason for failure is printed inside the function
+			return;
+		}
+		freeActivitySlotCount--;
+		activityEntries[_available_id].subScheduleId = subScheduleId;
+		activityEntries[_available_id].groupId = groupId;
+		scheduleActivityEntry(_available_id, releaseTime);
+		const auto journalStatus = appendJournalRecord(Journal_Record::insert, _available_id);
+		if (journalStatus != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
+			status = journalStatus;
 		}
-		iterationCount-=1;
 	}
-	sortActivityEntries(entries);
-	auto status = storeActivityEntries(entries);
 
 	if (status != GENERIC_ERROR_NONE) {
 		Services.requestVerification.failCompletionExecutionVerification(request, static_cast<SpacecraftErrorCode>(status));
@@ -403,8 +795,7 @@ void TimeBasedSchedulingService::timeShiftAllActivities(Message& request) {
 		return;
 	}
 
-	ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities];
-	if (readActivityEntries(entries) != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
+	if (not activityIndexLoaded && (loadActivityIndex() != SpacecraftErrorCode::GENERIC_ERROR_NONE)) {
 		// Reason for failure is printed inside the function
 		return;
 	}
@@ -419,15 +810,20 @@ void TimeBasedSchedulingService::timeShiftAllActivities(Message& request) {
 	// }
 
 	LOG_DEBUG<<"[TC_SCHEDULING] Time shifting activities by: "<<relativeOffset<<" s";
-	for (int i=0; i< ECSSMaxNumberOfTimeSchedActivities; i++) {
-		if (entries[i].state == Activity_State::waiting) {
-			entries[i].timestamp += std::chrono::seconds(relativeOffset);
+	for (const auto& entry: activityEntries) {
+		if (entry.state == Activity_State::waiting) {
+			scheduleActivityEntry(entry.id, entry.timestamp + std::chrono::seconds(relativeOffset));
 		}
 	}
-	auto status = storeActivityEntries(entries);
 
+	// A single snapshot, so that either all the activities or none of them are shifted after a reset
+	const auto status = compactActivityJournal();
 	if (status != GENERIC_ERROR_NONE) {
+		// Back to the activities that are stored, which are not shifted
+		activityIndexLoaded = false;
+		loadActivityIndex();
 		Services.requestVerification.failCompletionExecutionVerification(request, static_cast<SpacecraftErrorCode>(status));
+		return; // Exit execution
 	}
 	Services.requestVerification.successCompletionExecutionVerification(request);
 
@@ -489,6 +885,22 @@ void TimeBasedSchedulingService::execute(Message& message) {
 		case DetailReportAllScheduledActivities:
 			detailReportAllActivities(message);
 			break;
+#if SUB_SCHEDULES_ENABLED
+		case EnableTimeBasedSubSchedules:
+			enableSubSchedules(message);
+			break;
+		case DisableTimeBasedSubSchedules:
+			disableSubSchedules(message);
+			break;
+#endif
+#if GROUPS_ENABLED
+		case EnableTimeBasedSchedulingGroups:
+			enableGroups(message);
+			break;
+		case DisableTimeBasedSchedulingGroups:
+			disableGroups(message);
+			break;
+#endif
 		default:
 			ErrorHandler::reportError(message, ErrorHandler::OtherMessageType);
 			break;
@@ -503,15 +915,10 @@ void TimeBasedSchedulingService::initEsotericVariables() {
 	MemoryManager::getParameter(PeakSatParameters::OBDH_TC_SCHEDULE_ACTIVE_ID, static_cast<void*>(&_active_tc_schedule));
 	MemoryManager::getParameter(PeakSatParameters::OBDH_SCHEDULED_TC_EXECUTION_MARGIN_ID, static_cast<void*>(&_tc_execution_margin));
 
-	ActivityEntry entries[ECSSMaxNumberOfTimeSchedActivities] = {0};
 	if (_valid_schedule_list == 0) {
 		// Invalid schedule list, initialise array in MRAM with the correct IDs
-		for (int i=0; i<ECSSMaxNumberOfTimeSchedActivities;i++) {
-			entries[i].id = i;
-			entries[i].state = Activity_State::invalid;
-		}
 		LOG_DEBUG<<"[TC_SCHEDULING] Reset schedule list, initialization";
-		const auto status = storeActivityEntries(entries);
+		const auto status = resetActivityEntries();
 		if (status!=SpacecraftErrorCode::GENERIC_ERROR_NONE) {
 			LOG_ERROR<<"[TC_SCHEDULING] Error initialising schedule <SEC>"<<static_cast<uint16_t>(status);
 		}
@@ -520,9 +927,11 @@ void TimeBasedSchedulingService::initEsotericVariables() {
 	}
 
 
-	if (readActivityEntries(entries) != SpacecraftErrorCode::GENERIC_ERROR_NONE) {
-		// Reason for failure is printed inside the function
-		return;
+	const auto loadStatus = loadActivityIndex();
+	if (loadStatus == SpacecraftErrorCode::OBDH_ERROR_CORRUPTED_TC_SCHEDULE_FILE) {
+		// E.g. a schedule stored in an older format, which cannot be released safely
+		LOG_ERROR<<"[TC_SCHEDULING] Resetting unreadable schedule";
+		resetActivityEntries();
 	}
 
 	// uint8_t _stored_tc_to_check = 0;
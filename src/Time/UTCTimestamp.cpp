@@ -22,144 +22,23 @@ UTCTimestamp::UTCTimestamp(uint16_t year, uint8_t month, uint8_t day, uint8_t ho
 }
 
 bool UTCTimestamp::operator<(const UTCTimestamp& Date) const {
-	if (this->year < Date.year) {
-		return true;
-	}
-	if (this->year > Date.year) {
-		return false;
-	}
-
-	if (this->month < Date.month) {
-		return true;
-	}
-	if (this->month > Date.month) {
-		return false;
-	}
-
-	if (this->day < Date.day) {
-		return true;
-	}
-	if (this->day > Date.day) {
-		return false;
-	}
-
-	if (this->hour < Date.hour) {
-		return true;
-	}
-	if (this->hour > Date.hour) {
-		return false;
-	}
-
-	if (this->minute < Date.minute) {
-		return true;
-	}
-	if (this->minute > Date.minute) {
-		return false;
-	}
-
-	if (this->second < Date.second) {
-		return true;
-	}
-
-	return false;
+	return comparisonKey() < Date.comparisonKey();
 }
 
 bool UTCTimestamp::operator>(const UTCTimestamp& Date) const {
-	if (this->year > Date.year) {
-		return true;
-	}
-	if (this->year < Date.year) {
-		return false;
-	}
-	if (this->month > Date.month) {
-		return true;
-	}
-	if (this->month < Date.month) {
-		return false;
-	}
-	if (this->day > Date.day) {
-		return true;
-	}
-	if (this->day < Date.day) {
-		return false;
-	}
-	if (this->hour > Date.hour) {
-		return true;
-	}
-	if (this->hour < Date.hour) {
-		return false;
-	}
-	if (this->minute > Date.minute) {
-		return true;
-	}
-	if (this->minute < Date.minute) {
-		return false;
-	}
-	if (this->second > Date.second) {
-		return true;
-	}
-
-	return false;
+	return comparisonKey() > Date.comparisonKey();
 }
 
 bool UTCTimestamp::operator==(const UTCTimestamp& Date) const {
-	if (this->year != Date.year) {
-		return false;
-	}
-	if (this->month != Date.month) {
-		return false;
-	}
-	if (this->day != Date.day) {
-		return false;
-	}
-	if (this->hour != Date.hour) {
-		return false;
-	}
-	if (this->minute != Date.minute) {
-		return false;
-	}
-	if (this->second != Date.second) {
-		return false;
-	}
-	return true;
+	return comparisonKey() == Date.comparisonKey();
 }
 
 bool UTCTimestamp::operator<=(const UTCTimestamp& Date) const {
-	return ((*this < Date) || (*this == Date));
+	return comparisonKey() <= Date.comparisonKey();
 }
 
 bool UTCTimestamp::operator>=(const UTCTimestamp& Date) const {
-	return ((*this > Date) || (*this == Date));
-}
-void UTCTimestamp::repair() {
-	using namespace Time;
-
-	if (second > Time::SecondsPerMinute) {
-		second -= Time::SecondsPerMinute;
-		minute++;
-	}
-
-	const auto MinutesPerHour = SecondsPerHour / SecondsPerMinute;
-	if (minute >= MinutesPerHour) {
-		minute -= MinutesPerHour;
-		hour++;
-	}
-
-	const auto HoursPerDay = SecondsPerDay / SecondsPerHour;
-	if (hour >= HoursPerDay) {
-		hour -= HoursPerDay;
-		day++;
-	}
-
-	if (day > daysOfMonth()) {
-		day -= daysOfMonth();
-		month++;
-	}
-
-	if (month > MonthsPerYear) {
-		month -= MonthsPerYear;
-		year++;
-	}
+	return comparisonKey() >= Date.comparisonKey();
 }
 
 template <>
@@ -179,32 +58,25 @@ void convertValueToString(String<LOGGER_MAX_MESSAGE_SIZE>& message, UTCTimestamp
 
 uint64_t UTCTimestamp::toEpochSeconds() const {
 	using namespace Time;
-	uint64_t epochSeconds = 0ULL;
-
-	// Calculate seconds from epoch to the start of the year
-	for (uint16_t y = UNIXEpochYear; y < year; ++y) {
-		epochSeconds += (isLeapYear(y) ? 366ULL : 365ULL) * static_cast<uint64_t>(SecondsPerDay);
-	}
-
-	// Add days for months in current year
-	for (uint8_t m = 1U; m < month; ++m) {
-		uint8_t daysInMonth = DaysOfMonth[m - 1U];
-
-		// Account for leap year in February
-		if (m == 2U && isLeapYear(year)) {
-			daysInMonth += 1U;
-		}
-
-		epochSeconds += static_cast<uint64_t>(daysInMonth) * static_cast<uint64_t>(SecondsPerDay);
-	}
-
-	// Add days in current month (subtract 1 since day is 1-based)
-	epochSeconds += static_cast<uint64_t>(day - 1U) * static_cast<uint64_t>(SecondsPerDay);
 
-	// Add time components
+	uint64_t epochSeconds = static_cast<uint64_t>(daysFromCivil(year, month, day)) * static_cast<uint64_t>(SecondsPerDay);
 	epochSeconds += static_cast<uint64_t>(hour) * static_cast<uint64_t>(SecondsPerHour);
 	epochSeconds += static_cast<uint64_t>(minute) * static_cast<uint64_t>(SecondsPerMinute);
 	epochSeconds += static_cast<uint64_t>(second);
 
 	return epochSeconds;
-}
\ No newline at end of file
+}
+
+UTCTimestamp UTCTimestamp::fromEpochSeconds(uint64_t epochSeconds) {
+	using namespace Time;
+
+	const CivilDate date = civilFromDays(static_cast<int32_t>(epochSeconds / SecondsPerDay));
+	auto secondOfDay = static_cast<uint32_t>(epochSeconds % SecondsPerDay);
+
+	const auto hour = static_cast<uint8_t>(secondOfDay / SecondsPerHour);
+	secondOfDay %= SecondsPerHour;
+	const auto minute = static_cast<uint8_t>(secondOfDay / SecondsPerMinute);
+	const auto second = static_cast<uint8_t>(secondOfDay % SecondsPerMinute);
+
+	return {date.year, date.month, date.day, hour, minute, second};
+}